@@ -0,0 +1,256 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 03/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JniBitmap.h"
+#include <string>
+#include "JniExceptions.h"
+#include "android/bitmap.h"
+#include "ReformatBitmap.h"
+#include "imagebit/CopyUnaligned.h"
+#include "conversion/ExpandRgba.h"
+#include "colorspaces/ColorSpaceProfile.h"
+#include "colorspaces/GamutAdapter.h"
+#include "hwy/highway.h"
+
+void AdaptColorEncoding(uint8_t *pixels, uint32_t stride,
+                        uint32_t width, uint32_t height, bool useFloats,
+                        const JxlColorEncoding &colorEncoding, CurveToneMapper toneMapper,
+                        int components, bool useFloat32) {
+  if (components < 3) {
+    return;
+  }
+  if ((colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA ||
+      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB)
+      && colorEncoding.color_space == JXL_COLOR_SPACE_RGB) {
+    Eigen::Matrix3f sourceProfile;
+    GamutTransferFunction function = SKIP;
+    GammaCurve gammaCurve = sRGB;
+    bool useChromaticAdaptation = false;
+    float gamma = 2.2f;
+    if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
+      function = HLG;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
+      toneMapper = TONE_SKIP;
+      function = SMPTE428;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
+      function = PQ;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA) {
+      toneMapper = TONE_SKIP;
+      function = EOTF_GAMMA;
+      gamma = 1.f / colorEncoding.gamma;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
+      toneMapper = TONE_SKIP;
+      function = EOTF_BT709;
+    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
+      toneMapper = TONE_SKIP;
+      function = EOTF_SRGB;
+    }
+
+    if (colorEncoding.primaries == JXL_PRIMARIES_2100) {
+      sourceProfile = GamutRgbToXYZ(getRec2020Primaries(), getIlluminantD65());
+    } else if (colorEncoding.primaries == JXL_PRIMARIES_P3) {
+      sourceProfile = GamutRgbToXYZ(getDisplayP3Primaries(), getIlluminantD65());
+    } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB) {
+      sourceProfile = GamutRgbToXYZ(getSRGBPrimaries(), getIlluminantD65());
+    } else {
+      Eigen::Matrix<float, 3, 2> primaries;
+      primaries << static_cast<float>(colorEncoding.primaries_red_xy[0]),
+          static_cast<float>(colorEncoding.primaries_red_xy[1]),
+          static_cast<float>(colorEncoding.primaries_green_xy[0]),
+          static_cast<float>(colorEncoding.primaries_green_xy[1]),
+          static_cast<float>(colorEncoding.primaries_blue_xy[0]),
+          static_cast<float>(colorEncoding.primaries_blue_xy[1]);
+      Eigen::Vector2f whitePoint = {static_cast<float>(colorEncoding.white_point_xy[0]),
+                                    static_cast<float>(colorEncoding.white_point_xy[1])};
+      if (whitePoint != getIlluminantD65()) {
+        useChromaticAdaptation = true;
+      }
+      sourceProfile = GamutRgbToXYZ(primaries, whitePoint);
+      gammaCurve = sRGB;
+    }
+
+    Eigen::Matrix3f dstProfile = GamutRgbToXYZ(getRec709Primaries(), getIlluminantD65());
+    Eigen::Matrix3f conversion = dstProfile.inverse() * sourceProfile;
+
+    if (useFloat32) {
+      coder::GamutAdapter<hwy::float32_t> adapter(reinterpret_cast<hwy::float32_t *>(pixels), stride,
+                                                  width, height,
+                                                  16,
+                                                  gammaCurve, function,
+                                                  toneMapper, &conversion, gamma,
+                                                  useChromaticAdaptation, components);
+      adapter.transfer();
+    } else if (useFloats) {
+      coder::GamutAdapter<hwy::float16_t> adapter(reinterpret_cast<hwy::float16_t *>(pixels), stride,
+                                                  width, height,
+                                                  16,
+                                                  gammaCurve, function,
+                                                  toneMapper, &conversion, gamma,
+                                                  useChromaticAdaptation, components);
+      adapter.transfer();
+    } else {
+      coder::GamutAdapter<uint8_t> adapter(pixels, stride,
+                                           width, height,
+                                           8,
+                                           gammaCurve, function,
+                                           toneMapper, &conversion, gamma,
+                                           useChromaticAdaptation, components);
+      adapter.transfer();
+    }
+  }
+}
+
+jobject CreateBitmap(JNIEnv *env, std::vector<uint8_t> &pixels, uint32_t stride,
+                     uint32_t width, uint32_t height, bool useFloats, int bitDepth,
+                     PreferredColorConfig preferredColorConfig,
+                     bool alphaPremultiplied, bool hasAlphaInOrigin,
+                     int components) {
+  if (components != 4) {
+    PreferredColorConfig config = ResolvePreferredColorConfig(preferredColorConfig, bitDepth,
+                                                              hasAlphaInOrigin);
+    bool opaque = components == 1 || components == 3;
+    if (opaque && ((config == Rgba_8888 && !useFloats) || (config == Rgba_F16 && useFloats))) {
+      // Nothing left to premultiply or reformat, expand right into the bitmap
+      void *addr;
+      uint32_t bitmapStride;
+      jobject bitmapObj = CreateLockedBitmap(env, width, height, useFloats ? "RGBA_F16" : "ARGB_8888",
+                                             &addr, &bitmapStride);
+      if (!bitmapObj) {
+        return nullptr;
+      }
+      if (useFloats) {
+        coder::ExpandToRGBA(reinterpret_cast<const hwy::float16_t *>(pixels.data()), stride, components,
+                            reinterpret_cast<hwy::float16_t *>(addr), bitmapStride, width, height);
+      } else {
+        coder::ExpandToRGBA(pixels.data(), stride, components,
+                            reinterpret_cast<uint8_t *>(addr), bitmapStride, width, height);
+      }
+      if (AndroidBitmap_unlockPixels(env, bitmapObj) != 0) {
+        throwPixelsException(env);
+        return static_cast<jobject>(nullptr);
+      }
+      pixels.clear();
+      return bitmapObj;
+    }
+
+    uint32_t rgbaStride = width * 4 * static_cast<uint32_t>(useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+    std::vector<uint8_t> rgbaPixels(rgbaStride * height);
+    if (useFloats) {
+      coder::ExpandToRGBA(reinterpret_cast<const hwy::float16_t *>(pixels.data()), stride, components,
+                          reinterpret_cast<hwy::float16_t *>(rgbaPixels.data()), rgbaStride, width, height);
+    } else {
+      coder::ExpandToRGBA(pixels.data(), stride, components,
+                          rgbaPixels.data(), rgbaStride, width, height);
+    }
+    pixels = std::move(rgbaPixels);
+    stride = rgbaStride;
+  }
+
+  uint32_t imageStride = stride;
+  std::string bitmapPixelConfig = useFloats ? "RGBA_F16" : "ARGB_8888";
+  jobject hwBuffer = nullptr;
+  ReformatColorConfig(env, pixels, bitmapPixelConfig, preferredColorConfig, bitDepth,
+                      width, height, &imageStride, &useFloats,
+                      &hwBuffer, alphaPremultiplied, hasAlphaInOrigin);
+
+  if (bitmapPixelConfig == "HARDWARE") {
+    jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
+    jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass,
+                                                            "wrapHardwareBuffer",
+                                                            "(Landroid/hardware/HardwareBuffer;Landroid/graphics/ColorSpace;)Landroid/graphics/Bitmap;");
+    jobject emptyObject = nullptr;
+    jobject bitmapObj = env->CallStaticObjectMethod(bitmapClass,
+                                                    createBitmapMethodID,
+                                                    hwBuffer, emptyObject);
+    return bitmapObj;
+  }
+
+  void *addr;
+  uint32_t bitmapStride;
+  jobject bitmapObj = CreateLockedBitmap(env, width, height, bitmapPixelConfig, &addr, &bitmapStride);
+  if (!bitmapObj) {
+    return nullptr;
+  }
+
+  if (bitmapPixelConfig == "RGB_565") {
+    coder::CopyUnaligned(reinterpret_cast<const uint8_t *>(pixels.data()), imageStride,
+                         reinterpret_cast<uint8_t *>(addr), (int) bitmapStride,
+                         (int) width,
+                         (int) height, sizeof(uint16_t));
+  } else {
+    coder::CopyUnaligned(reinterpret_cast<const uint8_t *>(pixels.data()), imageStride,
+                         reinterpret_cast<uint8_t *>(addr), (int) bitmapStride,
+                         (int) width * 4,
+                         (int) height,
+                         useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+  }
+
+  if (AndroidBitmap_unlockPixels(env, bitmapObj) != 0) {
+    throwPixelsException(env);
+    return static_cast<jobject>(nullptr);
+  }
+
+  pixels.clear();
+
+  return bitmapObj;
+}
+
+jobject CreateLockedBitmap(JNIEnv *env, uint32_t width, uint32_t height,
+                           const std::string &bitmapPixelConfig,
+                           void **addr, uint32_t *stride) {
+  jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
+  jfieldID rgba8888FieldID = env->GetStaticFieldID(bitmapConfig,
+                                                   bitmapPixelConfig.c_str(),
+                                                   "Landroid/graphics/Bitmap$Config;");
+  jobject rgba8888Obj = env->GetStaticObjectField(bitmapConfig, rgba8888FieldID);
+
+  jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
+  jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass, "createBitmap",
+                                                          "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
+  jobject bitmapObj = env->CallStaticObjectMethod(bitmapClass, createBitmapMethodID,
+                                                  static_cast<jint>(width),
+                                                  static_cast<jint>(height),
+                                                  rgba8888Obj);
+
+  AndroidBitmapInfo info;
+  if (AndroidBitmap_getInfo(env, bitmapObj, &info) < 0) {
+    throwPixelsException(env);
+    return static_cast<jobject>(nullptr);
+  }
+
+  if (AndroidBitmap_lockPixels(env, bitmapObj, addr) != 0) {
+    throwPixelsException(env);
+    return static_cast<jobject>(nullptr);
+  }
+  *stride = info.stride;
+  return bitmapObj;
+}
@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 03/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JNIBITMAP_H
+#define JXLCODER_JNIBITMAP_H
+
+#include <jni.h>
+#include <string>
+#include <vector>
+#include "color_encoding.h"
+#include "Support.h"
+
+/**
+ * Converts pixels described by a libjxl colour encoding into Rec.709 in place.
+ * Pixels are RGB or RGBA depending on components, gray layouts have nothing to adapt.
+ * Float pixels are half floats unless useFloat32 is set.
+ */
+void AdaptColorEncoding(uint8_t *pixels, uint32_t stride,
+                        uint32_t width, uint32_t height, bool useFloats,
+                        const JxlColorEncoding &colorEncoding, CurveToneMapper toneMapper,
+                        int components = 4, bool useFloat32 = false);
+
+/**
+ * Reformats decoded pixels into the preferred config and wraps them into android.graphics.Bitmap.
+ * Gray, gray + alpha and RGB pixels are expanded to RGBA here, opaque ones straight into the bitmap
+ * when no other conversion is required.
+ * @return nullptr with pending java exception on failure
+ */
+jobject CreateBitmap(JNIEnv *env, std::vector<uint8_t> &pixels, uint32_t stride,
+                     uint32_t width, uint32_t height, bool useFloats, int bitDepth,
+                     PreferredColorConfig preferredColorConfig,
+                     bool alphaPremultiplied, bool hasAlphaInOrigin,
+                     int components = 4);
+
+/**
+ * Creates android.graphics.Bitmap of the given config and locks its pixels.
+ * @return nullptr with pending java exception on failure
+ */
+jobject CreateLockedBitmap(JNIEnv *env, uint32_t width, uint32_t height,
+                           const std::string &bitmapPixelConfig,
+                           void **addr, uint32_t *stride);
+
+#endif //JXLCODER_JNIBITMAP_H
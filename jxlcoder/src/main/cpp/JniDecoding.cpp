@@ -26,6 +26,7 @@
  *
  */
 
+#include "JniDecoding.h"
 #include <jni.h>
 #include <vector>
 #include "interop/JxlDecoding.h"
@@ -37,17 +38,23 @@
 #include "SizeScaler.h"
 #include "Support.h"
 #include "ReformatBitmap.h"
+#include "JniBitmap.h"
+#include "conversion/RGBAlpha.h"
 #include "imagebit/CopyUnaligned.h"
 #include "XScaler.h"
 #include "colorspaces/ColorSpaceProfile.h"
 #include "colorspaces/GamutAdapter.h"
 #include "colorspaces/ColorSpaceProfile.h"
 #include "hwy/highway.h"
+#include "jxl/resizable_parallel_runner.h"
+#include "processing/StreamingResampler.h"
 
 jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jint scaledWidth,
                                jint scaledHeight,
                                jint javaPreferredColorConfig,
-                               jint javaScaleMode, jint javaResizeFilter, jint javaToneMapper) {
+                               jint javaScaleMode, jint javaResizeFilter, jint javaToneMapper,
+                               const JxlRegion *region,
+                               JxlDecodeScratch *scratch) {
   ScaleMode scaleMode;
   PreferredColorConfig preferredColorConfig;
   XSampler sampler;
@@ -57,9 +64,14 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
                                 javaToneMapper, &toneMapper)) {
     return nullptr;
   }
+  const bool linearLight = (javaResizeFilter & kLinearLightSampling) != 0;
 
-  std::vector<uint8_t> rgbaPixels;
-  std::vector<uint8_t> iccProfile;
+  std::vector<uint8_t> ownPixels;
+  std::vector<uint8_t> ownIccProfile;
+  std::vector<uint8_t> &rgbaPixels = scratch ? scratch->pixels : ownPixels;
+  std::vector<uint8_t> &iccProfile = scratch ? scratch->iccProfile : ownIccProfile;
+  rgbaPixels.clear();
+  iccProfile.clear();
   size_t xsize = 0, ysize = 0;
   bool useBitmapFloats = false;
   bool alphaPremultiplied = false;
@@ -69,198 +81,203 @@ jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jin
   JxlColorEncoding colorEncoding;
   bool preferEncoding = false;
   bool hasAlphaInOrigin = true;
-  if (!DecodeJpegXlOneShot(reinterpret_cast<uint8_t *>(imageData.data()), imageData.size(),
-                           &rgbaPixels,
-                           &xsize, &ysize,
-                           &iccProfile, &useBitmapFloats, &bitDepth, &alphaPremultiplied,
-                           osVersion >= 26,
-                           &jxlOrientation,
-                           &preferEncoding, &colorEncoding,
-                           &hasAlphaInOrigin)) {
-    throwInvalidJXLException(env);
+  int components = 4;
+  bool useFloat32 = false;
+
+  bool useSampler = (scaledWidth > 0 || scaledHeight > 0) && (scaledWidth != 0 && scaledHeight != 0);
+
+  // Downscaling is done while decoding so the full size frame is never materialized
+  JxlSamplePlanner planner = [&](size_t imageWidth, size_t imageHeight, JxlSampledTarget *target) {
+    if (!useSampler) {
+      return false;
+    }
+    ScaleBounds bounds = ComputeScaleBounds(static_cast<int>(imageWidth), static_cast<int>(imageHeight),
+                                            scaledWidth, scaledHeight, scaleMode);
+    if (bounds.width <= 0 || bounds.height <= 0
+        || bounds.scaledWidth >= static_cast<int>(imageWidth)
+        || bounds.scaledHeight >= static_cast<int>(imageHeight)) {
+      return false;
+    }
+    // Streaming only pays off while the rows it keeps in flight are smaller than the decoded frame
+    const size_t sampleSize = useBitmapFloats ? sizeof(float) : sizeof(uint8_t);
+    const size_t fullFrame = imageWidth * imageHeight * 4 * sampleSize;
+    const size_t footprint = coder::StreamingResampler::EstimateFootprint(
+        static_cast<int>(imageWidth), static_cast<int>(imageHeight), bounds.scaledHeight, bounds.width,
+        4, sampleSize, sampler, JxlResizableParallelRunnerSuggestThreads(imageWidth, imageHeight));
+    if (footprint >= fullFrame) {
+      return false;
+    }
+    target->srcX = 0;
+    target->srcY = 0;
+    target->srcWidth = static_cast<int>(imageWidth);
+    target->srcHeight = static_cast<int>(imageHeight);
+    target->scaledWidth = bounds.scaledWidth;
+    target->scaledHeight = bounds.scaledHeight;
+    target->x = bounds.x;
+    target->y = bounds.y;
+    target->width = bounds.width;
+    target->height = bounds.height;
+    target->sampler = sampler;
+    target->linearLight = linearLight;
+    return true;
+  };
+
+  bool sampled = false;
+
+  // Pixels go straight into the bitmap when every remaining stage can work in place
+  jobject directBitmap = nullptr;
+  JxlTargetProvider provider = [&](size_t width, size_t height, bool useFloats, JxlDecodeTarget *target) {
+    if (!iccProfile.empty() || (useSampler && !sampled)) {
+      return false;
+    }
+    PreferredColorConfig config = ResolvePreferredColorConfig(preferredColorConfig, bitDepth, hasAlphaInOrigin);
+    if (!(config == Rgba_8888 && !useFloats) && !(config == Rgba_F16 && useFloats)) {
+      return false;
+    }
+    void *addr;
+    uint32_t bitmapStride;
+    directBitmap = CreateLockedBitmap(env, width, height, useFloats ? "RGBA_F16" : "ARGB_8888",
+                                      &addr, &bitmapStride);
+    if (!directBitmap) {
+      target->data = nullptr;
+      return true;
+    }
+    target->data = reinterpret_cast<uint8_t *>(addr);
+    target->stride = bitmapStride;
+    return true;
+  };
+
+  JxlDecodeTarget direct = {nullptr, 0};
+  if (region) {
+    useSampler = false;
+    if (!DecodeJpegXlRegion(reinterpret_cast<uint8_t *>(imageData.data()), imageData.size(),
+                            &rgbaPixels,
+                            &xsize, &ysize,
+                            &iccProfile, &useBitmapFloats, &bitDepth, &alphaPremultiplied,
+                            osVersion >= 26,
+                            &jxlOrientation,
+                            &preferEncoding, &colorEncoding,
+                            &hasAlphaInOrigin,
+                            *region, sampler, &components, &useFloat32)) {
+      std::string errorString = "Image is not a valid JPEG XL or region lies outside of the image";
+      throwException(env, errorString);
+      return nullptr;
+    }
+  } else if (!DecodeJpegXlInto(reinterpret_cast<uint8_t *>(imageData.data()), imageData.size(),
+                               &rgbaPixels,
+                               &xsize, &ysize,
+                               &iccProfile, &useBitmapFloats, &bitDepth, &alphaPremultiplied,
+                               osVersion >= 26,
+                               &jxlOrientation,
+                               &preferEncoding, &colorEncoding,
+                               &hasAlphaInOrigin,
+                               planner, &sampled,
+                               provider, &direct, &components, &useFloat32,
+                               scratch ? &scratch->session : nullptr)) {
+    if (directBitmap) {
+      AndroidBitmap_unlockPixels(env, directBitmap);
+    }
+    if (!env->ExceptionCheck()) {
+      throwInvalidJXLException(env);
+    }
     return nullptr;
   }
 
-  if (jxlOrientation == JXL_ORIENT_ROTATE_90_CW || jxlOrientation == JXL_ORIENT_ROTATE_90_CCW ||
-      jxlOrientation == JXL_ORIENT_ANTI_TRANSPOSE || jxlOrientation == JXL_ORIENT_TRANSPOSE) {
+  // Decoded pixels are already oriented, the reported size is the stored one.
+  // Sampled decodes already report the oriented target size
+  if (!sampled && (jxlOrientation == JXL_ORIENT_ROTATE_90_CW || jxlOrientation == JXL_ORIENT_ROTATE_90_CCW ||
+      jxlOrientation == JXL_ORIENT_ANTI_TRANSPOSE || jxlOrientation == JXL_ORIENT_TRANSPOSE)) {
     size_t xz = xsize;
     xsize = ysize;
     ysize = xz;
   }
 
+  if (direct.data) {
+    imageData.clear();
+    if (preferEncoding) {
+      AdaptColorEncoding(direct.data, direct.stride, xsize, ysize, useBitmapFloats,
+                         colorEncoding, toneMapper);
+    }
+    if (!useBitmapFloats && !alphaPremultiplied && hasAlphaInOrigin) {
+      coder::PremultiplyRGBA(direct.data, direct.stride, xsize, ysize);
+    }
+    if (AndroidBitmap_unlockPixels(env, directBitmap) != 0) {
+      throwPixelsException(env);
+      return static_cast<jobject>(nullptr);
+    }
+    return directBitmap;
+  }
+
   imageData.clear();
 
+  // High bit depth pixels stay in 32 bit floats until the bitmap is created
+  const size_t sampleSize = useFloat32 ? sizeof(float) : (useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+
   if (!iccProfile.empty()) {
-    size_t stride = (size_t) xsize * 4 * (size_t) (useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+    size_t stride = (size_t) xsize * components * sampleSize;
     convertUseDefinedColorSpace(rgbaPixels,
                                 stride,
                                 static_cast<size_t>(xsize),
                                 static_cast<size_t>(ysize),
                                 iccProfile.data(),
                                 iccProfile.size(),
-                                useBitmapFloats);
+                                useBitmapFloats && !useFloat32,
+                                components,
+                                useFloat32);
   }
 
-  bool useSampler = (scaledWidth > 0 || scaledHeight > 0) && (scaledWidth != 0 && scaledHeight != 0);
-
   uint32_t finalWidth = xsize;
   uint32_t finalHeight = ysize;
-  uint32_t stride = static_cast<uint32_t >(finalWidth) * 4 * static_cast<uint32_t >(useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+  uint32_t stride = static_cast<uint32_t >(finalWidth) * components * static_cast<uint32_t >(sampleSize);
 
-  if (useSampler) {
-    auto scaleResult = RescaleImage(rgbaPixels, env, &stride, useBitmapFloats,
+  if (useSampler && !sampled) {
+    // ICC pixels are sRGB by now, encodings adapted after scaling keep their own curve until then
+    const bool sRGBTransfer = !preferEncoding || colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB;
+    bool scaleResult;
+    const XAlphaMode alphaMode = ResampleAlphaMode(hasAlphaInOrigin, alphaPremultiplied,
+                                                   useBitmapFloats, preferEncoding);
+    if (useFloat32) {
+      scaleResult = RescaleImageF32(rgbaPixels, &stride,
                                     reinterpret_cast<uint32_t *>(&finalWidth),
                                     reinterpret_cast<uint32_t *>(&finalHeight),
                                     static_cast<uint32_t >(scaledWidth),
                                     static_cast<uint32_t >(scaledHeight),
-                                    alphaPremultiplied, scaleMode,
-                                    sampler);
-    if (!scaleResult) {
-      return nullptr;
-    }
-  }
-
-  if (preferEncoding && (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
-      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
-      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
-      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
-      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA ||
-      colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB)
-      && colorEncoding.color_space == JXL_COLOR_SPACE_RGB) {
-    Eigen::Matrix3f sourceProfile;
-    GamutTransferFunction function = SKIP;
-    GammaCurve gammaCurve = sRGB;
-    bool useChromaticAdaptation = false;
-    float gamma = 2.2f;
-    if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_HLG) {
-      function = HLG;
-    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_DCI) {
-      toneMapper = TONE_SKIP;
-      function = SMPTE428;
-    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_PQ) {
-      function = PQ;
-    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA) {
-      toneMapper = TONE_SKIP;
-      function = EOTF_GAMMA;
-      gamma = 1.f / colorEncoding.gamma;
-    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_709) {
-      toneMapper = TONE_SKIP;
-      function = EOTF_BT709;
-    } else if (colorEncoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB) {
-      toneMapper = TONE_SKIP;
-      function = EOTF_SRGB;
-    }
-
-    if (colorEncoding.primaries == JXL_PRIMARIES_2100) {
-      sourceProfile = GamutRgbToXYZ(getRec2020Primaries(), getIlluminantD65());
-    } else if (colorEncoding.primaries == JXL_PRIMARIES_P3) {
-      sourceProfile = GamutRgbToXYZ(getDisplayP3Primaries(), getIlluminantD65());
-    } else if (colorEncoding.primaries == JXL_PRIMARIES_SRGB) {
-      sourceProfile = GamutRgbToXYZ(getSRGBPrimaries(), getIlluminantD65());
+                                    scaleMode, sampler, components, alphaMode,
+                                    linearLight && sRGBTransfer);
     } else {
-      Eigen::Matrix<float, 3, 2> primaries;
-      primaries << static_cast<float>(colorEncoding.primaries_red_xy[0]),
-          static_cast<float>(colorEncoding.primaries_red_xy[1]),
-          static_cast<float>(colorEncoding.primaries_green_xy[0]),
-          static_cast<float>(colorEncoding.primaries_green_xy[1]),
-          static_cast<float>(colorEncoding.primaries_blue_xy[0]),
-          static_cast<float>(colorEncoding.primaries_blue_xy[1]);
-      Eigen::Vector2f whitePoint = {static_cast<float>(colorEncoding.white_point_xy[0]),
-                                    static_cast<float>(colorEncoding.white_point_xy[1])};
-      if (whitePoint != getIlluminantD65()) {
-        useChromaticAdaptation = true;
-      }
-      sourceProfile = GamutRgbToXYZ(primaries, whitePoint);
-      gammaCurve = sRGB;
+      scaleResult = RescaleImage(rgbaPixels, env, &stride, useBitmapFloats,
+                                 reinterpret_cast<uint32_t *>(&finalWidth),
+                                 reinterpret_cast<uint32_t *>(&finalHeight),
+                                 static_cast<uint32_t >(scaledWidth),
+                                 static_cast<uint32_t >(scaledHeight),
+                                 alphaMode, scaleMode,
+                                 sampler, components,
+                                 linearLight && sRGBTransfer);
     }
-
-    Eigen::Matrix3f dstProfile = GamutRgbToXYZ(getRec709Primaries(), getIlluminantD65());
-    Eigen::Matrix3f conversion = dstProfile.inverse() * sourceProfile;
-
-    if (useBitmapFloats) {
-      coder::GamutAdapter<hwy::float16_t> adapter(reinterpret_cast<hwy::float16_t *>(rgbaPixels.data()), stride,
-                                                  finalWidth, finalHeight,
-                                                  16,
-                                                  gammaCurve, function,
-                                                  toneMapper, &conversion, gamma,
-                                                  useChromaticAdaptation);
-      adapter.transfer();
-    } else {
-      coder::GamutAdapter<uint8_t> adapter(rgbaPixels.data(), stride,
-                                           finalWidth, finalHeight,
-                                           8,
-                                           gammaCurve, function,
-                                           toneMapper, &conversion, gamma,
-                                           useChromaticAdaptation);
-      adapter.transfer();
+    if (!scaleResult) {
+      return nullptr;
     }
+    alphaPremultiplied = alphaPremultiplied || alphaMode == alphaPremultiplyOutput;
   }
 
-  std::string bitmapPixelConfig = useBitmapFloats ? "RGBA_F16" : "ARGB_8888";
-  jobject hwBuffer = nullptr;
-  ReformatColorConfig(env, rgbaPixels, bitmapPixelConfig, preferredColorConfig, bitDepth,
-                      finalWidth, finalHeight, &stride, &useBitmapFloats,
-                      &hwBuffer, alphaPremultiplied, hasAlphaInOrigin);
-
-  if (bitmapPixelConfig == "HARDWARE") {
-    jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
-    jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass,
-                                                            "wrapHardwareBuffer",
-                                                            "(Landroid/hardware/HardwareBuffer;Landroid/graphics/ColorSpace;)Landroid/graphics/Bitmap;");
-    jobject emptyObject = nullptr;
-    jobject bitmapObj = env->CallStaticObjectMethod(bitmapClass,
-                                                    createBitmapMethodID,
-                                                    hwBuffer, emptyObject);
-    return bitmapObj;
-  }
-
-  jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
-  jfieldID rgba8888FieldID = env->GetStaticFieldID(bitmapConfig,
-                                                   bitmapPixelConfig.c_str(),
-                                                   "Landroid/graphics/Bitmap$Config;");
-  jobject rgba8888Obj = env->GetStaticObjectField(bitmapConfig, rgba8888FieldID);
-
-  jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
-  jmethodID createBitmapMethodID = env->GetStaticMethodID(bitmapClass, "createBitmap",
-                                                          "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
-  jobject bitmapObj = env->CallStaticObjectMethod(bitmapClass, createBitmapMethodID,
-                                                  static_cast<jint>(finalWidth),
-                                                  static_cast<jint>(finalHeight),
-                                                  rgba8888Obj);
-
-  AndroidBitmapInfo info;
-  if (AndroidBitmap_getInfo(env, bitmapObj, &info) < 0) {
-    throwPixelsException(env);
-    return static_cast<jbyteArray>(nullptr);
-  }
-
-  void *addr;
-  if (AndroidBitmap_lockPixels(env, bitmapObj, &addr) != 0) {
-    throwPixelsException(env);
-    return static_cast<jobject>(nullptr);
-  }
-
-  if (bitmapPixelConfig == "RGB_565") {
-    coder::CopyUnaligned(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), stride,
-                         reinterpret_cast<uint8_t *>(addr), (int) info.stride,
-                         (int) info.width,
-                         (int) info.height, sizeof(uint16_t));
-  } else {
-    coder::CopyUnaligned(reinterpret_cast<const uint8_t *>(rgbaPixels.data()), stride,
-                         reinterpret_cast<uint8_t *>(addr), (int) info.stride,
-                         (int) info.width * 4,
-                         (int) info.height,
-                         useBitmapFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+  if (preferEncoding) {
+    AdaptColorEncoding(rgbaPixels.data(), stride, finalWidth, finalHeight, useBitmapFloats,
+                       colorEncoding, toneMapper, components, useFloat32);
   }
 
-  if (AndroidBitmap_unlockPixels(env, bitmapObj) != 0) {
-    throwPixelsException(env);
-    return static_cast<jobject>(nullptr);
+  if (useFloat32) {
+    uint32_t halfStride = finalWidth * components * static_cast<uint32_t>(sizeof(uint16_t));
+    std::vector<uint8_t> halfPixels(halfStride * finalHeight);
+    coder::F32ToF16(reinterpret_cast<const float *>(rgbaPixels.data()), stride,
+                    reinterpret_cast<uint16_t *>(halfPixels.data()), halfStride,
+                    finalWidth, finalHeight, components);
+    rgbaPixels = std::move(halfPixels);
+    stride = halfStride;
   }
 
-  rgbaPixels.clear();
-
-  return bitmapObj;
+  return CreateBitmap(env, rgbaPixels, stride, finalWidth, finalHeight, useBitmapFloats,
+                      bitDepth, preferredColorConfig, alphaPremultiplied, hasAlphaInOrigin,
+                      components);
 }
 
 extern "C"
@@ -318,22 +335,95 @@ Java_com_awxkee_jxlcoder_JxlCoder_decodeByteBufferSampledImpl(JNIEnv *env, jobje
 
 extern "C"
 JNIEXPORT jobject JNICALL
-Java_com_awxkee_jxlcoder_JxlCoder_getSizeImpl(JNIEnv *env, jobject thiz, jbyteArray byte_array) {
-  auto totalLength = env->GetArrayLength(byte_array);
-  std::shared_ptr<void> srcBuffer(static_cast<char *>(malloc(totalLength)),
-                                  [](void *b) { free(b); });
-  env->GetByteArrayRegion(byte_array, 0, totalLength, reinterpret_cast<jbyte *>(srcBuffer.get()));
+Java_com_awxkee_jxlcoder_JxlCoder_decodeRegionImpl(JNIEnv *env, jobject thiz,
+                                                   jbyteArray byte_array,
+                                                   jint x, jint y, jint width, jint height,
+                                                   jfloat scale,
+                                                   jint javaPreferredColorConfig,
+                                                   jint resizeSampler,
+                                                   jint javaToneMapper) {
+  if (x < 0 || y < 0 || width <= 0 || height <= 0) {
+    std::string errorString = "Region must have non negative origin and positive size";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  if (!(scale > 0.f && scale <= 1.f)) {
+    std::string errorString = "Region scale must be in (0, 1]";
+    throwException(env, errorString);
+    return nullptr;
+  }
+  try {
+    auto totalLength = env->GetArrayLength(byte_array);
+    std::vector<uint8_t> srcBuffer(totalLength);
+    env->GetByteArrayRegion(byte_array, 0, totalLength,
+                            reinterpret_cast<jbyte *>(srcBuffer.data()));
+    JxlRegion region = {x, y, width, height, scale};
+    return decodeSampledImageImpl(env, srcBuffer, 0, 0,
+                                  javaPreferredColorConfig, Resize,
+                                  resizeSampler, javaToneMapper, &region);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "Not enough memory to decode this image";
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
 
-  std::vector<uint8_t> icc_profile;
-  size_t xsize = 0, ysize = 0;
-  if (!DecodeBasicInfo(reinterpret_cast<uint8_t *>(srcBuffer.get()), totalLength, &xsize,
-                       &ysize)) {
+/**
+ * Feeds the probe straight from the java array, only header bytes are copied out of it
+ */
+static bool ProbeByteArray(JNIEnv *env, jbyteArray byteArray, bool countFrames, JxlImageProbe *probe) {
+  auto totalLength = static_cast<size_t>(env->GetArrayLength(byteArray));
+  JxlInputReader reader = [&](size_t offset, size_t size, uint8_t *dst) -> size_t {
+    env->GetByteArrayRegion(byteArray, static_cast<jsize>(offset), static_cast<jsize>(size),
+                            reinterpret_cast<jbyte *>(dst));
+    return env->ExceptionCheck() ? 0 : size;
+  };
+  return ProbeJpegXl(reader, totalLength, countFrames, probe);
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_getSizeImpl(JNIEnv *env, jobject thiz, jbyteArray byte_array) {
+  JxlImageProbe probe;
+  if (!ProbeByteArray(env, byte_array, false, &probe)) {
     return nullptr;
   }
 
   jclass sizeClass = env->FindClass("android/util/Size");
   jmethodID methodID = env->GetMethodID(sizeClass, "<init>", "(II)V");
-  auto sizeObject = env->NewObject(sizeClass, methodID, static_cast<jint >(xsize),
-                                   static_cast<jint>(ysize));
+  auto sizeObject = env->NewObject(sizeClass, methodID, static_cast<jint >(probe.width),
+                                   static_cast<jint>(probe.height));
   return sizeObject;
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_com_awxkee_jxlcoder_JxlCoder_getInfoImpl(JNIEnv *env, jobject thiz, jbyteArray byte_array,
+                                              jboolean countFrames) {
+  JxlImageProbe probe;
+  if (!ProbeByteArray(env, byte_array, static_cast<bool>(countFrames), &probe)) {
+    return nullptr;
+  }
+
+  jlong values[13] = {
+      static_cast<jlong>(probe.width),
+      static_cast<jlong>(probe.height),
+      static_cast<jlong>(probe.orientation),
+      static_cast<jlong>(probe.bitsPerSample),
+      static_cast<jlong>(probe.exponentBitsPerSample),
+      probe.hasAlpha ? 1 : 0,
+      probe.animated ? 1 : 0,
+      static_cast<jlong>(probe.numberOfFrames),
+      static_cast<jlong>(probe.loopsCount),
+      probe.hasColorEncoding ? static_cast<jlong>(probe.colorEncoding.primaries) : -1,
+      probe.hasColorEncoding ? static_cast<jlong>(probe.colorEncoding.transfer_function) : -1,
+      probe.hasColorEncoding ? static_cast<jlong>(probe.colorEncoding.white_point) : -1,
+      static_cast<jlong>(probe.iccSize),
+  };
+  jlongArray result = env->NewLongArray(13);
+  if (!result) {
+    return nullptr;
+  }
+  env->SetLongArrayRegion(result, 0, 13, values);
+  return result;
 }
\ No newline at end of file
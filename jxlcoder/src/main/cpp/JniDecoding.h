@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JNIDECODING_H
+#define JXLCODER_JNIDECODING_H
+
+#include <jni.h>
+#include <vector>
+#include "interop/JxlDecoding.h"
+
+/**
+ * Decoder session and buffers reused by consecutive decodings,
+ * vectors keep their capacity so same sized images don't allocate again.
+ */
+struct JxlDecodeScratch {
+  JxlDecoderSession session;
+  std::vector<uint8_t> input;
+  std::vector<uint8_t> pixels;
+  std::vector<uint8_t> iccProfile;
+};
+
+/**
+ * Decodes the image into android.graphics.Bitmap downscaled to scaledWidth x scaledHeight,
+ * non positive size keeps the original one.
+ * @return nullptr with pending java exception on failure
+ */
+jobject decodeSampledImageImpl(JNIEnv *env, std::vector<uint8_t> &imageData, jint scaledWidth,
+                               jint scaledHeight,
+                               jint javaPreferredColorConfig,
+                               jint javaScaleMode, jint javaResizeFilter, jint javaToneMapper,
+                               const JxlRegion *region = nullptr,
+                               JxlDecodeScratch *scratch = nullptr);
+
+#endif //JXLCODER_JNIDECODING_H
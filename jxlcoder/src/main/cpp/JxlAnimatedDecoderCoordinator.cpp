@@ -175,7 +175,7 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
     // Currently always in 8bpp;
     bool useFloat16 = false;
     const int depth = 8;
-    const bool alphaPremultiplied = coordinator->isAlphaAttenuated();
+    bool alphaPremultiplied = coordinator->isAlphaAttenuated();
 
     auto preferEncoding = frame.preferColorEncoding;
     auto colorEncoding = frame.colorEncoding;
@@ -281,15 +281,20 @@ Java_com_awxkee_jxlcoder_JxlAnimatedImage_getFrameImpl(JNIEnv *env, jobject thiz
     uint32_t finalHeight = coordinator->getHeight();
 
     if (useSampler && scaledHeight > 0 && scaledWidth > 0) {
+      // Colours are already final here
+      const XAlphaMode alphaMode = ResampleAlphaMode(frame.hasAlphaInOrigin, alphaPremultiplied,
+                                                     useFloat16, false);
       auto scaleResult = RescaleImage(rgbaPixels, env, &stride, useFloat16,
                                       reinterpret_cast<uint32_t *>(&finalWidth),
                                       reinterpret_cast<uint32_t *>(&finalHeight),
-                                      scaledWidth, scaledHeight, alphaPremultiplied,
+                                      scaledWidth, scaledHeight, alphaMode,
                                       coordinator->getScaleMode(),
-                                      coordinator->getSampler());
+                                      coordinator->getSampler(), 4, false,
+                                      &coordinator->getResizePlans());
       if (!scaleResult) {
         return nullptr;
       }
+      alphaPremultiplied = alphaPremultiplied || alphaMode == alphaPremultiplyOutput;
     }
 
     std::string bitmapPixelConfig = useFloat16 ? "RGBA_F16" : "ARGB_8888";
@@ -104,12 +104,18 @@ class JxlAnimatedDecoderCoordinator {
     return decoder->isAlphaAttenuated();
   }
 
+  // Frames share one size, so the resize plan is built for the first frame and reused after it
+  coder::ResizePlanCache &getResizePlans() {
+    return resizePlans;
+  }
+
  private:
   JxlAnimatedDecoder *decoder;
   ScaleMode scaleMode;
   PreferredColorConfig preferredColorConfig;
   XSampler sampler;
   CurveToneMapper toneMapper;
+  coder::ResizePlanCache resizePlans;
 };
 
 #endif //JXLCODER_JXLANIMATEDDECODERCOORDINATOR_H
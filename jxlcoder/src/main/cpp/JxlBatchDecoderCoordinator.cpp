@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlBatchDecoderCoordinator.h"
+#include <jni.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "android/bitmap.h"
+#include "JniExceptions.h"
+#include "Support.h"
+
+using namespace std;
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlBatchDecoder_createBatchCoordinator(JNIEnv *env, jobject thiz,
+                                                                jint javaPreferredColorConfig,
+                                                                jint javaScaleMode,
+                                                                jint javaJxlResizeSampler,
+                                                                jint javaToneMapper) {
+  ScaleMode scaleMode;
+  PreferredColorConfig preferredColorConfig;
+  XSampler sampler;
+  CurveToneMapper toneMapper;
+  if (!checkDecodePreconditions(env, javaPreferredColorConfig, &preferredColorConfig,
+                                javaScaleMode, &scaleMode, javaJxlResizeSampler, &sampler,
+                                javaToneMapper, &toneMapper)) {
+    return 0;
+  }
+
+  try {
+    auto coordinator = new JxlBatchDecoderCoordinator(javaPreferredColorConfig, javaScaleMode,
+                                                      javaJxlResizeSampler, javaToneMapper);
+    if (!coordinator->prepare()) {
+      delete coordinator;
+      std::string errorString = "Cannot create JPEG XL decoder";
+      throwException(env, errorString);
+      return 0;
+    }
+    return reinterpret_cast<jlong >(coordinator);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  }
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_awxkee_jxlcoder_JxlBatchDecoder_decodeBatchImpl(JNIEnv *env, jobject thiz,
+                                                         jlong coordinatorPtr,
+                                                         jobjectArray images,
+                                                         jintArray widths,
+                                                         jintArray heights,
+                                                         jlongArray statistics) {
+  auto coordinator = reinterpret_cast<JxlBatchDecoderCoordinator *>(coordinatorPtr);
+  jsize count = env->GetArrayLength(images);
+  if (env->GetArrayLength(widths) != count || env->GetArrayLength(heights) != count) {
+    std::string errorString = "Every image must have its target size";
+    throwException(env, errorString);
+    return nullptr;
+  }
+
+  jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
+  jobjectArray bitmaps = env->NewObjectArray(count, bitmapClass, nullptr);
+  env->DeleteLocalRef(bitmapClass);
+  if (!bitmaps) {
+    return nullptr;
+  }
+
+  vector<jint> targetWidths(count);
+  vector<jint> targetHeights(count);
+  env->GetIntArrayRegion(widths, 0, count, targetWidths.data());
+  env->GetIntArrayRegion(heights, 0, count, targetHeights.data());
+
+  JxlBatchStatistics batch = {0, 0, 0, 0, 0};
+  JxlDecodeScratch *scratch = coordinator->getScratch();
+  auto start = chrono::steady_clock::now();
+
+  for (jsize i = 0; i < count; ++i) {
+    // Every item gets its own frame so long batches don't exhaust local references
+    if (env->PushLocalFrame(16) != 0) {
+      return nullptr;
+    }
+    auto byteArray = reinterpret_cast<jbyteArray>(env->GetObjectArrayElement(images, i));
+    jobject bitmap = nullptr;
+    if (byteArray) {
+      try {
+        auto totalLength = env->GetArrayLength(byteArray);
+        scratch->input.resize(totalLength);
+        env->GetByteArrayRegion(byteArray, 0, totalLength,
+                                reinterpret_cast<jbyte *>(scratch->input.data()));
+        batch.inputBytes += totalLength;
+        bitmap = decodeSampledImageImpl(env, scratch->input, targetWidths[i], targetHeights[i],
+                                        coordinator->getPreferredColorConfig(),
+                                        coordinator->getScaleMode(),
+                                        coordinator->getSampler(),
+                                        coordinator->getToneMapper(),
+                                        nullptr, scratch);
+      } catch (std::bad_alloc &err) {
+        bitmap = nullptr;
+      }
+    }
+    // One broken image must not drop the rest of the batch, it is reported as null
+    if (env->ExceptionCheck()) {
+      env->ExceptionClear();
+      bitmap = nullptr;
+    }
+    bitmap = env->PopLocalFrame(bitmap);
+    if (bitmap) {
+      AndroidBitmapInfo info;
+      if (AndroidBitmap_getInfo(env, bitmap, &info) == 0) {
+        batch.outputPixels += static_cast<int64_t>(info.width) * static_cast<int64_t>(info.height);
+      }
+      env->SetObjectArrayElement(bitmaps, i, bitmap);
+      env->DeleteLocalRef(bitmap);
+      batch.decoded += 1;
+    } else {
+      batch.failed += 1;
+    }
+  }
+
+  batch.elapsedNanos = chrono::duration_cast<chrono::nanoseconds>(
+      chrono::steady_clock::now() - start).count();
+
+  if (statistics && env->GetArrayLength(statistics) >= 5) {
+    jlong values[5] = {
+        static_cast<jlong>(batch.decoded),
+        static_cast<jlong>(batch.failed),
+        static_cast<jlong>(batch.inputBytes),
+        static_cast<jlong>(batch.outputPixels),
+        static_cast<jlong>(batch.elapsedNanos),
+    };
+    env->SetLongArrayRegion(statistics, 0, 5, values);
+  }
+  return bitmaps;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlBatchDecoder_closeAndReleaseBatchDecoder(JNIEnv *env, jobject thiz,
+                                                                     jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlBatchDecoderCoordinator *>(coordinatorPtr);
+  delete coordinator;
+}
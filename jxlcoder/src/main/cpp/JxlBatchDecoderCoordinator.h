@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_JXLBATCHDECODERCOORDINATOR_H
+#define JXLCODER_JXLBATCHDECODERCOORDINATOR_H
+
+#include <jni.h>
+#include "JniDecoding.h"
+
+/**
+ * Totals of the last batch, elapsed time covers decoding and bitmaps creation.
+ */
+struct JxlBatchStatistics {
+  int64_t decoded;
+  int64_t failed;
+  int64_t inputBytes;
+  int64_t outputPixels;
+  int64_t elapsedNanos;
+};
+
+class JxlBatchDecoderCoordinator {
+
+ public:
+  JxlBatchDecoderCoordinator(jint preferredColorConfig, jint scaleMode,
+                             jint sampler, jint toneMapper) :
+      preferredColorConfig(preferredColorConfig), scaleMode(scaleMode),
+      sampler(sampler), toneMapper(toneMapper) {
+
+  }
+
+  /**
+   * Creates the decoder session, runner threads are started lazily by libjxl
+   */
+  bool prepare() {
+    return JxlCreateDecoderSession(&scratch.session);
+  }
+
+  JxlDecodeScratch *getScratch() {
+    return &scratch;
+  }
+
+  jint getPreferredColorConfig() {
+    return preferredColorConfig;
+  }
+
+  jint getScaleMode() {
+    return scaleMode;
+  }
+
+  jint getSampler() {
+    return sampler;
+  }
+
+  jint getToneMapper() {
+    return toneMapper;
+  }
+
+ private:
+  JxlDecodeScratch scratch;
+  jint preferredColorConfig;
+  jint scaleMode;
+  jint sampler;
+  jint toneMapper;
+};
+
+#endif //JXLCODER_JXLBATCHDECODERCOORDINATOR_H
@@ -0,0 +1,214 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 03/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlStreamingDecoderCoordinator.h"
+#include <jni.h>
+#include <string>
+#include <vector>
+#include "JniExceptions.h"
+#include "JniBitmap.h"
+#include "colorspaces/colorspace.h"
+
+using namespace std;
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_createStreamingCoordinator(JNIEnv *env, jobject thiz,
+                                                                        jboolean progressive,
+                                                                        jint javaPreferredColorConfig,
+                                                                        jint javaScaleMode,
+                                                                        jint javaJxlResizeSampler,
+                                                                        jint javaToneMapper) {
+  ScaleMode scaleMode;
+  PreferredColorConfig preferredColorConfig;
+  XSampler sampler;
+  CurveToneMapper toneMapper;
+  if (!checkDecodePreconditions(env, javaPreferredColorConfig, &preferredColorConfig,
+                                javaScaleMode, &scaleMode, javaJxlResizeSampler, &sampler,
+                                javaToneMapper, &toneMapper)) {
+    return 0;
+  }
+
+  try {
+    auto decoder = new JxlStreamingDecoder(androidOSVersion() >= 26, progressive);
+    auto coordinator = new JxlStreamingDecoderCoordinator(
+        decoder, scaleMode, preferredColorConfig, sampler, toneMapper
+    );
+    return reinterpret_cast<jlong >(coordinator);
+  } catch (StreamingDecoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+    return 0;
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_appendImpl(JNIEnv *env, jobject thiz,
+                                                        jlong coordinatorPtr,
+                                                        jbyteArray byteArray,
+                                                        jint offset, jint length) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  auto totalLength = env->GetArrayLength(byteArray);
+  if (offset < 0 || length < 0 || offset + length > totalLength) {
+    std::string errorString = "Offset and length must be inside of the array";
+    throwException(env, errorString);
+    return;
+  }
+  try {
+    vector<uint8_t> chunk(length);
+    env->GetByteArrayRegion(byteArray, offset, length, reinterpret_cast<jbyte *>(chunk.data()));
+    coordinator->getDecoder()->append(chunk.data(), chunk.size());
+  } catch (StreamingDecoderError &err) {
+    std::string errorString = err.what();
+    throwException(env, errorString);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_closeInputImpl(JNIEnv *env, jobject thiz,
+                                                            jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  coordinator->getDecoder()->closeInput();
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_processImpl(JNIEnv *env, jobject thiz,
+                                                         jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  try {
+    JxlStreamingStatus status = coordinator->getDecoder()->process();
+    if (status == StreamingError) {
+      throwInvalidJXLException(env);
+      return 0;
+    }
+    return static_cast<jint>(status);
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return 0;
+  }
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_getDownsamplingRatioImpl(JNIEnv *env, jobject thiz,
+                                                                      jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  return coordinator->getDecoder()->getDownsamplingRatio();
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_getProgressImpl(JNIEnv *env, jobject thiz,
+                                                             jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  JxlStreamingProgress progress = coordinator->getDecoder()->getProgress();
+  jlong values[7] = {
+      static_cast<jlong>(progress.bytesReceived),
+      static_cast<jlong>(progress.bytesConsumed),
+      static_cast<jlong>(progress.decodedPixels),
+      static_cast<jlong>(progress.totalPixels),
+      static_cast<jlong>(progress.passes),
+      progress.hasBasicInfo ? 1 : 0,
+      progress.complete ? 1 : 0,
+  };
+  jlongArray result = env->NewLongArray(7);
+  env->SetLongArrayRegion(result, 0, 7, values);
+  return result;
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_getImageImpl(JNIEnv *env, jobject thiz,
+                                                          jlong coordinatorPtr,
+                                                          jint scaleWidth, jint scaleHeight) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  JxlStreamingDecoder *decoder = coordinator->getDecoder();
+  if (!decoder->hasPixels()) {
+    return nullptr;
+  }
+  try {
+    vector<uint8_t> rgbaPixels = decoder->getPixels();
+    bool useFloats = decoder->isUseFloats();
+    uint32_t finalWidth = decoder->getWidth();
+    uint32_t finalHeight = decoder->getHeight();
+    uint32_t stride = finalWidth * 4 * static_cast<uint32_t>(useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+    bool alphaPremultiplied = decoder->isAlphaPremultiplied();
+
+    vector<uint8_t> &iccProfile = decoder->getIccProfile();
+    if (!iccProfile.empty()) {
+      convertUseDefinedColorSpace(rgbaPixels, stride, finalWidth, finalHeight,
+                                  iccProfile.data(), iccProfile.size(), useFloats);
+    }
+
+    bool useSampler = scaleWidth > 0 && scaleHeight > 0;
+    if (useSampler) {
+      const XAlphaMode alphaMode = ResampleAlphaMode(decoder->isHasAlphaInOrigin(), alphaPremultiplied,
+                                                     useFloats, decoder->isPreferEncoding());
+      if (!RescaleImage(rgbaPixels, env, &stride, useFloats,
+                        &finalWidth, &finalHeight,
+                        static_cast<uint32_t>(scaleWidth), static_cast<uint32_t>(scaleHeight),
+                        alphaMode, coordinator->getScaleMode(),
+                        coordinator->getSampler())) {
+        return nullptr;
+      }
+      alphaPremultiplied = alphaPremultiplied || alphaMode == alphaPremultiplyOutput;
+    }
+
+    if (decoder->isPreferEncoding()) {
+      AdaptColorEncoding(rgbaPixels.data(), stride, finalWidth, finalHeight, useFloats,
+                         decoder->getColorEncoding(), coordinator->getToneMapper());
+    }
+
+    return CreateBitmap(env, rgbaPixels, stride, finalWidth, finalHeight, useFloats,
+                        decoder->getBitDepth(), coordinator->getPreferredColorConfig(),
+                        alphaPremultiplied, decoder->isHasAlphaInOrigin());
+  } catch (std::bad_alloc &err) {
+    std::string errorString = "OOM: " + string(err.what());
+    throwException(env, errorString);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_awxkee_jxlcoder_JxlStreamingDecoder_closeAndReleaseStreamingDecoder(JNIEnv *env, jobject thiz,
+                                                                             jlong coordinatorPtr) {
+  auto coordinator = reinterpret_cast<JxlStreamingDecoderCoordinator *>(coordinatorPtr);
+  delete coordinator;
+}
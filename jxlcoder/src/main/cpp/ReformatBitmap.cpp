@@ -41,12 +41,8 @@
 #include "JniExceptions.h"
 #include "conversion/RGBAlpha.h"
 
-void
-ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &imageConfig,
-                    PreferredColorConfig preferredColorConfig, uint32_t depth,
-                    uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
-                    jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin) {
-  *hwBuffer = nullptr;
+PreferredColorConfig ResolvePreferredColorConfig(PreferredColorConfig preferredColorConfig,
+                                                 uint32_t depth, const bool hasAlphaInOrigin) {
   if (preferredColorConfig == Default) {
     int osVersion = androidOSVersion();
     if (depth > 8 && osVersion >= 26) {
@@ -59,6 +55,16 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
       preferredColorConfig = Rgba_8888;
     }
   }
+  return preferredColorConfig;
+}
+
+void
+ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &imageConfig,
+                    PreferredColorConfig preferredColorConfig, uint32_t depth,
+                    uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride, bool *useFloats,
+                    jobject *hwBuffer, bool alphaPremultiplied, const bool hasAlphaInOrigin) {
+  *hwBuffer = nullptr;
+  preferredColorConfig = ResolvePreferredColorConfig(preferredColorConfig, depth, hasAlphaInOrigin);
   switch (preferredColorConfig) {
     case Rgba_8888:
       if (*useFloats) {
@@ -73,7 +79,7 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
         imageData = rgba8888Data;
       } else {
         if (!alphaPremultiplied) {
-          coder::PremultiplyRGBA(imageData.data(), *stride, imageData.data(), *stride,
+          coder::PremultiplyRGBA(imageData.data(), *stride,
                                  imageWidth,
                                  imageHeight);
         }
@@ -166,7 +172,6 @@ ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &i
 
       if (!*useFloats && !alphaPremultiplied) {
         coder::PremultiplyRGBA(imageData.data(), *stride,
-                               imageData.data(), *stride,
                                imageWidth,
                                imageHeight);
       }
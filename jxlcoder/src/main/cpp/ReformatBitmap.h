@@ -32,6 +32,12 @@
 #include <vector>
 #include "Support.h"
 
+/**
+ * Replaces Default with the config that fits the image bit depth and the OS version.
+ */
+PreferredColorConfig ResolvePreferredColorConfig(PreferredColorConfig preferredColorConfig,
+                                                 uint32_t depth, const bool hasAlphaInOrigin);
+
 void
 ReformatColorConfig(JNIEnv *env, std::vector<uint8_t> &imageData, std::string &imageConfig,
                     PreferredColorConfig preferredColorConfig, uint32_t depth,
@@ -29,25 +29,73 @@
 #include "SizeScaler.h"
 #include <vector>
 #include <string>
+#include <thread>
 #include <jni.h>
 #include "JniExceptions.h"
 #include "XScaler.h"
-#include "processing/Convolve1D.h"
-#include "processing/Convolve1Db16.h"
 #include "Eigen/Eigen"
+#include "processing/StreamingResampler.h"
+#include "concurrency.hpp"
 
-static std::vector<float> compute1DGaussianKernel(int width, float sigma) {
-  std::vector<float> kernel(ceil(width));
-  int mean = ceil(width) / 2;
-  float sum = 0;
-  const float scale = 1.f / (std::sqrtf(2 * M_PI) * sigma);
-  for (int x = 0; x < width; x++) {
-    kernel[x] = std::expf(-0.5 * std::powf((x - mean) / sigma, 2.0)) * scale;
-    sum += kernel[x];
+ScaleBounds ComputeScaleBounds(int imageWidth, int imageHeight,
+                               int scaledWidth, int scaledHeight,
+                               ScaleMode scaleMode) {
+  int xTranslation = 0, yTranslation = 0;
+  int canvasWidth = scaledWidth;
+  int canvasHeight = scaledHeight;
+
+  if (scaleMode == Fit || scaleMode == Fill) {
+    std::pair<int, int> currentSize(imageWidth, imageHeight);
+    if (scaledHeight > 0 && scaledWidth < 0) {
+      auto newBounds = ResizeAspectHeight(currentSize, scaledHeight, scaledWidth == -2);
+      scaledWidth = newBounds.first;
+      scaledHeight = newBounds.second;
+    } else if (scaledHeight < 0) {
+      auto newBounds = ResizeAspectWidth(currentSize, scaledHeight, scaledHeight == -2);
+      scaledWidth = newBounds.first;
+      scaledHeight = newBounds.second;
+    } else {
+      std::pair<int, int> dstSize;
+      float scale = 1;
+      if (scaleMode == Fill) {
+        std::pair<int, int> canvasSize(scaledWidth, scaledHeight);
+        dstSize = ResizeAspectFill(currentSize, canvasSize, &scale);
+      } else {
+        std::pair<int, int> canvasSize(scaledWidth, scaledHeight);
+        dstSize = ResizeAspectFit(currentSize, canvasSize, &scale);
+      }
+
+      xTranslation = std::max((int) (((float) dstSize.first - (float) canvasWidth) / 2.0f), 0);
+      yTranslation = std::max((int) (((float) dstSize.second - (float) canvasHeight) / 2.0f), 0);
+
+      scaledWidth = dstSize.first;
+      scaledHeight = dstSize.second;
+    }
   }
-  for (int x = 0; x < width; x++)
-    kernel[x] /= sum;
-  return std::move(kernel);
+
+  ScaleBounds bounds;
+  bounds.scaledWidth = scaledWidth;
+  bounds.scaledHeight = scaledHeight;
+  if (xTranslation > 0 || yTranslation > 0) {
+    // Truncated aspect sizes may leave the scaled image a pixel short of the canvas
+    bounds.x = xTranslation;
+    bounds.y = yTranslation;
+    bounds.width = std::min(canvasWidth, scaledWidth - xTranslation);
+    bounds.height = std::min(canvasHeight, scaledHeight - yTranslation);
+  } else {
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.width = scaledWidth;
+    bounds.height = scaledHeight;
+  }
+  return bounds;
+}
+
+XAlphaMode ResampleAlphaMode(bool hasAlpha, bool alphaPremultiplied, bool useFloats, bool colorStageFollows) {
+  if (!hasAlpha || alphaPremultiplied) {
+    return alphaAsIs;
+  }
+  return (useFloats || colorStageFollows) ? alphaStraight : alphaPremultiplyOutput;
 }
 
 bool RescaleImage(std::vector<uint8_t> &rgbaData,
@@ -56,139 +104,125 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
                   bool useFloats,
                   uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
                   uint32_t scaledWidth, uint32_t scaledHeight,
-                  bool alphaPremultiplied,
+                  XAlphaMode alphaMode,
                   ScaleMode scaleMode,
-                  XSampler sampler) {
+                  XSampler sampler,
+                  int components,
+                  bool linearLight,
+                  coder::ResizePlanCache *planCache) {
   int imageWidth = *imageWidthPtr;
   int imageHeight = *imageHeightPtr;
   if ((scaledHeight != 0 || scaledWidth != 0) && (scaledWidth != 0 && scaledHeight != 0)) {
 
-    int xTranslation = 0, yTranslation = 0;
-    int canvasWidth = scaledWidth;
-    int canvasHeight = scaledHeight;
-
-    if (scaleMode == Fit || scaleMode == Fill) {
-      std::pair<int, int> currentSize(imageWidth, imageHeight);
-      if (scaledHeight > 0 && scaledWidth < 0) {
-        auto newBounds = ResizeAspectHeight(currentSize, scaledHeight, scaledWidth == -2);
-        scaledWidth = newBounds.first;
-        scaledHeight = newBounds.second;
-      } else if (scaledHeight < 0) {
-        auto newBounds = ResizeAspectWidth(currentSize, scaledHeight, scaledHeight == -2);
-        scaledWidth = newBounds.first;
-        scaledHeight = newBounds.second;
-      } else {
-        std::pair<int, int> dstSize;
-        float scale = 1;
-        if (scaleMode == Fill) {
-          std::pair<int, int> canvasSize(scaledWidth, scaledHeight);
-          dstSize = ResizeAspectFill(currentSize, canvasSize, &scale);
-        } else {
-          std::pair<int, int> canvasSize(scaledWidth, scaledHeight);
-          dstSize = ResizeAspectFit(currentSize, canvasSize, &scale);
-        }
-
-        xTranslation = std::max((int) (((float) dstSize.first - (float) canvasWidth) / 2.0f), 0);
-        yTranslation = std::max((int) (((float) dstSize.second - (float) canvasHeight) / 2.0f), 0);
+    ScaleBounds bounds = ComputeScaleBounds(imageWidth, imageHeight,
+                                            static_cast<int>(scaledWidth), static_cast<int>(scaledHeight),
+                                            scaleMode);
+    scaledWidth = bounds.scaledWidth;
+    scaledHeight = bounds.scaledHeight;
+    // Fill crops the scaled image to the canvas, only pixels inside it are ever resampled
+    const int windowX = bounds.x, windowY = bounds.y;
+    const int canvasWidth = bounds.width;
+    const int canvasHeight = bounds.height;
 
-        scaledWidth = dstSize.first;
-        scaledHeight = dstSize.second;
-      }
-    }
-
-    int lineWidth = scaledWidth * static_cast<int>(useFloats ? sizeof(uint16_t) : sizeof(uint8_t)) * 4;
+    const int pixelSize = components * static_cast<int>(useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+    int lineWidth = canvasWidth * pixelSize;
     int alignment = 64;
     int padding = (alignment - (lineWidth % alignment)) % alignment;
     int imdStride = lineWidth + padding;
 
-    std::vector<uint8_t> newImageData(imdStride * scaledHeight);
+    std::vector<uint8_t> newImageData(imdStride * canvasHeight);
 
-    float ratio = std::min(static_cast<float>(scaledHeight) / static_cast<float>(imageHeight),
-                           static_cast<float>(scaledWidth) / static_cast<float>(imageWidth));
+    const uint8_t *source = rgbaData.data();
+    int sourceStride = static_cast<int>(*stride);
+    std::vector<uint8_t> boxed;
+    bool resampled = false;
 
-    if (useFloats) {
-      if (ratio < 0.5f) {
-        auto kernel = compute1DGaussianKernel(7, (7 - 1) / 6.f);
-        coder::convolve1D(reinterpret_cast<uint16_t *>(rgbaData.data()), *stride, imageWidth, imageHeight, kernel, kernel);
+    // Integer part of an area downscale is averaged in boxes, the kernel resamples only the residual.
+    // Boxes average encoded values, so linear light goes through the kernel alone. Straight alpha is
+    // weighted in the boxes too, boxes followed by the kernel hand it straight alpha again
+    if (sampler == area && !linearLight) {
+      const int factorX = std::max(imageWidth / static_cast<int>(scaledWidth), 1);
+      const int factorY = std::max(imageHeight / static_cast<int>(scaledHeight), 1);
+      if (factorX > 1 || factorY > 1) {
+        const int boxWidth = (imageWidth + factorX - 1) / factorX;
+        const int boxHeight = (imageHeight + factorY - 1) / factorY;
+        resampled = boxWidth == static_cast<int>(scaledWidth) && boxHeight == static_cast<int>(scaledHeight);
+        if (resampled) {
+          // Boxes map one to one onto output pixels, so only the blocks under the canvas are averaged
+          const int left = windowX * factorX;
+          const int top = windowY * factorY;
+          const int width = std::min(canvasWidth * factorX, imageWidth - left);
+          const int height = std::min(canvasHeight * factorY, imageHeight - top);
+          const uint8_t *origin = source + top * sourceStride + left * pixelSize;
+          if (useFloats) {
+            coder::boxDownscaleFloat16(reinterpret_cast<const uint16_t *>(origin), sourceStride,
+                                       width, height,
+                                       reinterpret_cast<uint16_t *>(newImageData.data()), imdStride,
+                                       factorX, factorY, components, alphaMode);
+          } else {
+            coder::boxDownscaleU8(origin, sourceStride, width, height,
+                                  newImageData.data(), imdStride, factorX, factorY, components, alphaMode);
+          }
+        } else {
+          const int boxStride = boxWidth * pixelSize;
+          const XAlphaMode boxAlphaMode = alphaMode == alphaAsIs ? alphaAsIs : alphaStraight;
+          boxed.resize(boxStride * boxHeight);
+          if (useFloats) {
+            coder::boxDownscaleFloat16(reinterpret_cast<const uint16_t *>(source), sourceStride,
+                                       imageWidth, imageHeight,
+                                       reinterpret_cast<uint16_t *>(boxed.data()), boxStride,
+                                       factorX, factorY, components, boxAlphaMode);
+          } else {
+            coder::boxDownscaleU8(source, sourceStride, imageWidth, imageHeight,
+                                  boxed.data(), boxStride, factorX, factorY, components, boxAlphaMode);
+          }
+          source = boxed.data();
+          sourceStride = boxStride;
+          imageWidth = boxWidth;
+          imageHeight = boxHeight;
+        }
       }
+    }
+
+    std::shared_ptr<const coder::ResizePlan> plan;
+    if (planCache && !resampled) {
+      plan = planCache->get({imageWidth, imageHeight,
+                             static_cast<int>(scaledWidth), static_cast<int>(scaledHeight),
+                             windowX, windowY, canvasWidth, canvasHeight, sampler, !useFloats});
+    }
 
-      coder::scaleImageFloat16(reinterpret_cast<const uint16_t *>(rgbaData.data()),
-                               imageWidth * 4 * (int) sizeof(uint16_t),
+    if (resampled) {
+      // Box reduction already produced the target size
+    } else if (useFloats) {
+      coder::scaleImageFloat16(reinterpret_cast<const uint16_t *>(source),
+                               sourceStride,
                                imageWidth, imageHeight,
                                reinterpret_cast<uint16_t *>(newImageData.data()),
                                imdStride,
                                scaledWidth, scaledHeight,
-                               4,
-                               sampler
+                               components,
+                               sampler,
+                               windowX, windowY, canvasWidth, canvasHeight,
+                               linearLight, alphaMode, plan.get()
       );
     } else {
-      if (ratio < 0.5f) {
-        auto kernel = compute1DGaussianKernel(7, (7 - 1) / 6.f);
-        coder::convolve1D(reinterpret_cast<uint8_t *>(rgbaData.data()), *stride, imageWidth, imageHeight, kernel, kernel);
-      }
-      coder::scaleImageU8(reinterpret_cast<const uint8_t *>(rgbaData.data()),
-                          (int) imageWidth * 4 * (int) sizeof(uint8_t),
+      coder::scaleImageU8(source,
+                          sourceStride,
                           imageWidth, imageHeight,
                           reinterpret_cast<uint8_t *>(newImageData.data()),
                           imdStride,
                           scaledWidth, scaledHeight,
-                          4, 8,
-                          sampler);
+                          components, 8,
+                          sampler,
+                          windowX, windowY, canvasWidth, canvasHeight,
+                          linearLight, alphaMode, plan.get());
     }
 
-    imageWidth = scaledWidth;
-    imageHeight = scaledHeight;
-
-    if (xTranslation > 0 || yTranslation > 0) {
-
-      int left = std::max(xTranslation, 0);
-      int right = xTranslation + canvasWidth;
-      int top = std::max(yTranslation, 0);
-      int bottom = yTranslation + canvasHeight;
-
-      int croppedWidth = right - left;
-      int croppedHeight = bottom - top;
-      int newStride =
-          croppedWidth * 4 * (int) (useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
-      int srcStride = imdStride;
-
-      std::vector<uint8_t> croppedImage(newStride * croppedHeight);
-
-      uint8_t *dstData = croppedImage.data();
-      auto srcData = reinterpret_cast<const uint8_t *>(newImageData.data());
-
-      for (int y = top, yc = 0; y < bottom; ++y, ++yc) {
-        int x = 0;
-        int xc = 0;
-        auto srcRow = reinterpret_cast<const uint8_t *>(srcData + srcStride * y);
-        auto dstRow = reinterpret_cast<uint8_t *>(dstData + newStride * yc);
-        for (x = left, xc = 0; x < right; ++x, ++xc) {
-          if (useFloats) {
-            auto dst = reinterpret_cast<uint16_t *>(dstRow + xc * 4 * sizeof(uint16_t));
-            auto src = reinterpret_cast<const uint16_t *>(srcRow +
-                x * 4 * sizeof(uint16_t));
-            dst[0] = src[0];
-            dst[1] = src[1];
-            dst[2] = src[2];
-            dst[3] = src[3];
-          } else {
-            auto dst = reinterpret_cast<uint32_t *>(dstRow);
-            auto src = reinterpret_cast<const uint32_t *>(srcRow);
-            dst[xc] = src[x];
-          }
-        }
-      }
-
-      imageWidth = croppedWidth;
-      imageHeight = croppedHeight;
+    imageWidth = canvasWidth;
+    imageHeight = canvasHeight;
 
-      rgbaData = croppedImage;
-      *stride = newStride;
-
-    } else {
-      rgbaData = newImageData;
-      *stride = imdStride;
-    }
+    rgbaData = std::move(newImageData);
+    *stride = imdStride;
 
     *imageWidthPtr = imageWidth;
     *imageHeightPtr = imageHeight;
@@ -197,6 +231,51 @@ bool RescaleImage(std::vector<uint8_t> &rgbaData,
   return true;
 }
 
+bool RescaleImageF32(std::vector<uint8_t> &pixels,
+                     uint32_t *stride,
+                     uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
+                     uint32_t scaledWidth, uint32_t scaledHeight,
+                     ScaleMode scaleMode, XSampler sampler,
+                     int components,
+                     XAlphaMode alphaMode,
+                     bool linearLight) {
+  if (scaledWidth == 0 || scaledHeight == 0) {
+    return true;
+  }
+  const int imageWidth = static_cast<int>(*imageWidthPtr);
+  const int imageHeight = static_cast<int>(*imageHeightPtr);
+  ScaleBounds bounds = ComputeScaleBounds(imageWidth, imageHeight,
+                                          static_cast<int>(scaledWidth), static_cast<int>(scaledHeight),
+                                          scaleMode);
+  if (bounds.width <= 0 || bounds.height <= 0) {
+    return false;
+  }
+
+  // Float samples go through the same resampler as the decoder callbacks, crop included
+  coder::StreamingResampler resampler(0, 0, imageWidth, imageHeight,
+                                      bounds.scaledWidth, bounds.scaledHeight,
+                                      bounds.x, bounds.y, bounds.width, bounds.height,
+                                      components, sampler, linearLight, alphaMode);
+  const int threadCount = std::clamp(
+      std::min(static_cast<int>(std::thread::hardware_concurrency()),
+               imageHeight * imageWidth / (256 * 256)), 1, 12);
+  uint32_t newStride = bounds.width * components * static_cast<uint32_t>(sizeof(float));
+  std::vector<uint8_t> scaledPixels(newStride * bounds.height);
+  resampler.setOutput(scaledPixels.data(), newStride, coder::streamingF32);
+  resampler.prepare(threadCount);
+  const uint8_t *src = pixels.data();
+  const uint32_t srcStride = *stride;
+  concurrency::parallel_for_with_thread_id(threadCount, imageHeight, [&](int threadId, int y) {
+    resampler.pushRow(threadId, 0, y, imageWidth, src + srcStride * y);
+  });
+
+  pixels = std::move(scaledPixels);
+  *stride = newStride;
+  *imageWidthPtr = bounds.width;
+  *imageHeightPtr = bounds.height;
+  return true;
+}
+
 std::pair<int, int>
 ResizeAspectFit(std::pair<int, int> sourceSize, std::pair<int, int> dstSize, float *scale) {
   int sourceWidth = sourceSize.first;
@@ -32,6 +32,7 @@
 #include <vector>
 #include <jni.h>
 #include "XScaler.h"
+#include "processing/ResizePlan.h"
 
 enum ScaleMode {
   Fit = 1,
@@ -39,14 +40,57 @@ enum ScaleMode {
   Resize = 3,
 };
 
+/**
+ * Scaled image size and the visible window of it that is returned to the caller,
+ * Fill mode crops the centered canvas out of the aspect filled image.
+ */
+struct ScaleBounds {
+  int scaledWidth;
+  int scaledHeight;
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+ScaleBounds ComputeScaleBounds(int imageWidth, int imageHeight,
+                               int scaledWidth, int scaledHeight,
+                               ScaleMode scaleMode);
+
+/**
+ * Alpha treatment for RescaleImage. Straight alpha is resampled premultiplied, 8 bit output is left
+ * premultiplied when no colour stage runs after scaling, so bitmap creation has nothing to premultiply.
+ */
+XAlphaMode ResampleAlphaMode(bool hasAlpha, bool alphaPremultiplied, bool useFloats, bool colorStageFollows);
+
+/**
+ * Rescales 8 bit or half float pixels to the requested size. When planCache is given the resize plan
+ * is taken from it, so callers scaling many same sized images build the weight tables only once.
+ */
 bool RescaleImage(std::vector<uint8_t> &rgbaData,
                   JNIEnv *env,
                   uint32_t *stride,
                   bool useFloats,
                   uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
                   uint32_t scaledWidth, uint32_t scaledHeight,
-                  bool alphaPremultiplied,
-                  ScaleMode scaleMode, XSampler sampler);
+                  XAlphaMode alphaMode,
+                  ScaleMode scaleMode, XSampler sampler,
+                  int components = 4,
+                  bool linearLight = false,
+                  coder::ResizePlanCache *planCache = nullptr);
+
+/**
+ * Rescales float samples of any channels count, Fill crop is applied while resampling.
+ * With linearLight sRGB encoded samples are filtered in linear light and encoded back.
+ */
+bool RescaleImageF32(std::vector<uint8_t> &pixels,
+                     uint32_t *stride,
+                     uint32_t *imageWidthPtr, uint32_t *imageHeightPtr,
+                     uint32_t scaledWidth, uint32_t scaledHeight,
+                     ScaleMode scaleMode, XSampler sampler,
+                     int components,
+                     XAlphaMode alphaMode = alphaAsIs,
+                     bool linearLight = false);
 
 std::pair<int, int>
 ResizeAspectFit(std::pair<int, int> sourceSize, std::pair<int, int> dstSize, float *scale);
@@ -77,7 +77,8 @@ bool checkDecodePreconditions(JNIEnv *env, jint javaColorspace, PreferredColorCo
     return false;
   }
 
-  auto xSampler = static_cast<XSampler>(javaSampler);
+  // Linear light request is read separately by the callers that support it
+  auto xSampler = static_cast<XSampler>(javaSampler & ~kLinearLightSampling);
   if (!xSampler) {
     std::string errorString =
         "Invalid Sampler: " + std::to_string(javaSampler) + " was passed";
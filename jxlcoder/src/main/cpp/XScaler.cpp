@@ -30,8 +30,12 @@
 #include "conversion/half.hpp"
 #include <thread>
 #include <vector>
+#include <cstring>
 #include "algo/sampler.h"
 #include "concurrency.hpp"
+#include "processing/ResampleWeights.h"
+#include "processing/ResizePlan.h"
+#include "processing/TransferLut.h"
 
 #if defined(__clang__)
 #pragma clang fp contract(fast) exceptions(ignore) reassociate(on)
@@ -42,7 +46,6 @@
 
 #include "hwy/foreach_target.h"
 #include "hwy/highway.h"
-#include "algo/sampler-inl.h"
 #include "algo/math-inl.h"
 #include "algo/sampler.h"
 
@@ -57,791 +60,898 @@ using namespace hwy::HWY_NAMESPACE;
 using hwy::float32_t;
 using hwy::float16_t;
 
-float SampleOptionResult(float value, const XSampler option) {
-  switch (option) {
-    case bilinear:break;
-    case nearest:break;
-    case cubic:return SimpleCubic(value);
-    case mitchell:return MitchellNetravalli(value);
-    case lanczos:return LanczosWindow(value, float(3));
-    case catmullRom:return CatmullRom(value);
-    case hermite:return CubicHermite(value);
-    case bSpline:return BSpline(value);
-    case hann:return Hann(value, float(3));
-    case bicubic:return BiCubicSpline(value);
-  }
-  return 0;
-}
-
-template<class D, typename T = Vec<D>>
-HWY_MATH_INLINE T SampleOptionResult(const D df, T x, const XSampler option) {
-  switch (option) {
-    case bilinear:break;
-    case nearest:break;
-    case cubic:return SimpleCubicV(df, x);
-    case mitchell:return MitchellNetravaliV(df, x);
-    case lanczos: {
-      const T a = Set(df, 3.0);
-      return LanczosWindowHWY(df, x, a);
-    }
-    case catmullRom:return CatmullRomV(df, x);
-    case hermite:return CubicHermiteV(df, x);
-    case bSpline:return CubicBSplineV(df, x);
-    case hann: {
-      return HannWindow(df, x, 3.0);
-    }
-    case bicubic:return BiCubicSplineV(df, x);
-  }
-  return Zero(df);
-}
-
-void
-scaleRowF16(const uint8_t *src8,
-            const int srcStride,
-            const int dstStride, int inputWidth,
-            int inputHeight,
-            uint16_t *output,
-            int outputWidth,
-            const float xScale,
-            const XSampler &option,
-            const float yScale, int y, const int components) {
-  auto dst8 = reinterpret_cast<uint8_t *>(output) + y * dstStride;
-  auto dst16 = reinterpret_cast<uint16_t *>(dst8);
-
-  const FixedTag<float32_t, 4> dfx4;
-  const FixedTag<int32_t, 4> dix4;
-  const FixedTag<float16_t, 4> df16x4;
-  using VI4 = Vec<decltype(dix4)>;
-  using VF4 = Vec<decltype(dfx4)>;
-  using VF16x4 = Vec<decltype(df16x4)>;
-
-  const int shift[4] = {0, 1, 2, 3};
-  const VI4 shiftV = LoadU(dix4, shift);
-  const VF4 xScaleV = Set(dfx4, xScale);
-  const VF4 yScaleV = Set(dfx4, yScale);
-  const VI4 addOne = Set(dix4, 1);
-  const VF4 fOneV = Set(dfx4, 1.0f);
-  const VI4 maxWidth = Set(dix4, inputWidth - 1);
-  const VI4 maxHeight = Set(dix4, inputHeight - 1);
-  const VI4 iZeros = Zero(dix4);
-  const VF4 vfZeros = Zero(dfx4);
-  const VI4 srcStrideV = Set(dix4, srcStride);
-  const int mMaxWidth = inputWidth - 1;
-  const int mMaxHeight = inputHeight - 1;
+void PromoteRowF32(const uint8_t *src, float *dst, const int count) {
+  const ScalableTag<float32_t> df;
+  const RebindToSigned<decltype(df)> di;
+  const Rebind<uint8_t, decltype(di)> du8;
+  const int lanes = static_cast<int>(Lanes(df));
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    StoreU(ConvertTo(df, PromoteTo(di, LoadU(du8, src + i))), df, dst + i);
+  }
+  for (; i < count; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
 
-  for (int x = 0; x < outputWidth; ++x) {
-    float srcX = (float) x * xScale;
-    float srcY = (float) y * yScale;
-
-    int x1 = static_cast<int>(srcX);
-    int y1 = static_cast<int>(srcY);
-
-    if (option == bilinear) {
-      if (components == 4 && x + 8 < outputWidth) {
-        VI4 currentX = Set(dix4, x);
-        VI4 currentXV = Add(currentX, shiftV);
-        VF4 currentXVF = Mul(ConvertTo(dfx4, currentXV), xScaleV);
-        VF4 currentYVF = Mul(ConvertTo(dfx4, Set(dix4, y)), yScaleV);
-
-        VI4 xi1 = ConvertTo(dix4, Floor(currentXVF));
-        VI4 yi1 = Min(ConvertTo(dix4, Floor(currentYVF)), maxHeight);
-
-        VI4 xi2 = Min(Add(xi1, addOne), maxWidth);
-        VI4 yi2 = Min(Add(yi1, addOne), maxHeight);
-
-        VI4 row1Add = Mul(yi1, srcStrideV);
-        VI4 row2Add = Mul(yi2, srcStrideV);
-
-        VF4 dx = Max(Sub(currentXVF, ConvertTo(dfx4, xi1)), vfZeros);
-        VF4 dy = Max(Sub(currentYVF, ConvertTo(dfx4, yi1)), vfZeros);
-
-        for (int i = 0; i < 4; i++) {
-          auto row1 = reinterpret_cast<const float16_t *>(src8 +
-              ExtractLane(row1Add, i));
-          auto row2 = reinterpret_cast<const float16_t *>(src8 +
-              ExtractLane(row2Add, i));
-          VF16x4 lane = LoadU(df16x4, &row1[ExtractLane(xi1, i) * components]);
-          VF4 c1 = PromoteTo(dfx4, lane);
-          lane = LoadU(df16x4, &row1[ExtractLane(xi2, i) * components]);
-          VF4 c2 = PromoteTo(dfx4, lane);
-          lane = LoadU(df16x4, &row2[ExtractLane(xi1, i) * components]);
-          VF4 c3 = PromoteTo(dfx4, lane);
-          lane = LoadU(df16x4, &row2[ExtractLane(xi2, i) * components]);
-          VF4 c4 = PromoteTo(dfx4, lane);
-          VF4 value = Blerp(dfx4, c1, c2, c3, c4, Set(dfx4, ExtractLane(dx, i)),
-                            Set(dfx4, ExtractLane(dy, i)));
-          VF16x4 pixel = DemoteTo(df16x4, Max(value, vfZeros));
-          auto u8Store = reinterpret_cast<float16_t *>(&dst16[
-              ExtractLane(currentXV, i) * components]);
-          StoreU(pixel, df16x4, u8Store);
-        }
+void PromoteRowF32(const uint16_t *src, float *dst, const int count) {
+  const ScalableTag<float32_t> df;
+  const Rebind<float16_t, decltype(df)> df16;
+  const int lanes = static_cast<int>(Lanes(df));
+  auto src16 = reinterpret_cast<const float16_t *>(src);
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    StoreU(PromoteTo(df, LoadU(df16, src16 + i)), df, dst + i);
+  }
+  for (; i < count; ++i) {
+    dst[i] = static_cast<float>(castU16(src[i]));
+  }
+}
 
-        x += components - 1;
-      } else {
-        int x2 = min(x1 + 1, inputWidth - 1);
-        int y2 = min(y1 + 1, inputHeight - 1);
+void PromoteRowI32(const uint8_t *src, int32_t *dst, const int count) {
+  const ScalableTag<int32_t> di;
+  const Rebind<uint8_t, decltype(di)> du8;
+  const int lanes = static_cast<int>(Lanes(di));
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    StoreU(PromoteTo(di, LoadU(du8, src + i)), di, dst + i);
+  }
+  for (; i < count; ++i) {
+    dst[i] = src[i];
+  }
+}
 
-        float dx((float) srcX - (float) x1);
-        float dy((float) srcY - (float) y1);
+void StoreRow(const float *src, uint8_t *dst, const int count, const float maxColors) {
+  const ScalableTag<float32_t> df;
+  const RebindToSigned<decltype(df)> di;
+  const Rebind<uint8_t, decltype(di)> du8;
+  const int lanes = static_cast<int>(Lanes(df));
+  const auto vfZeros = Zero(df);
+  const auto maxColorsV = Set(df, maxColors);
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    auto color = ClampRound(df, LoadU(df, src + i), vfZeros, maxColorsV);
+    StoreU(DemoteTo(du8, ConvertTo(di, color)), du8, dst + i);
+  }
+  for (; i < count; ++i) {
+    dst[i] = static_cast<uint8_t>(clamp(round(src[i]), 0.0f, maxColors));
+  }
+}
 
-        float invertDx = float(1.0f) - dx;
-        float invertDy = float(1.0f) - dy;
+void StoreRow(const float *src, uint16_t *dst, const int count, const float) {
+  const ScalableTag<float32_t> df;
+  const Rebind<float16_t, decltype(df)> df16;
+  const int lanes = static_cast<int>(Lanes(df));
+  auto dst16 = reinterpret_cast<float16_t *>(dst);
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    StoreU(DemoteTo(df16, LoadU(df, src + i)), df16, dst16 + i);
+  }
+  for (; i < count; ++i) {
+    dst[i] = half(src[i]).data_;
+  }
+}
 
-        auto row1 = reinterpret_cast<const uint16_t *>(src8 + y1 * srcStride);
-        auto row2 = reinterpret_cast<const uint16_t *>(src8 + y2 * srcStride);
+/**
+ * Splits interleaved pixels into components planes of width samples, planeStride apart
+ */
+template<typename T>
+void DeinterleaveRow(const T *src, T *planes, const size_t planeStride,
+                     const int width, const int components) {
+  if (components == 1) {
+    memcpy(planes, src, sizeof(T) * width);
+    return;
+  }
+  const ScalableTag<T> d;
+  using V = Vec<decltype(d)>;
+  const int lanes = static_cast<int>(Lanes(d));
+  int x = 0;
+  if (components == 4) {
+    for (; x + lanes <= width; x += lanes) {
+      V v0, v1, v2, v3;
+      LoadInterleaved4(d, src + x * 4, v0, v1, v2, v3);
+      StoreU(v0, d, planes + x);
+      StoreU(v1, d, planes + planeStride + x);
+      StoreU(v2, d, planes + planeStride * 2 + x);
+      StoreU(v3, d, planes + planeStride * 3 + x);
+    }
+  } else if (components == 3) {
+    for (; x + lanes <= width; x += lanes) {
+      V v0, v1, v2;
+      LoadInterleaved3(d, src + x * 3, v0, v1, v2);
+      StoreU(v0, d, planes + x);
+      StoreU(v1, d, planes + planeStride + x);
+      StoreU(v2, d, planes + planeStride * 2 + x);
+    }
+  } else if (components == 2) {
+    for (; x + lanes <= width; x += lanes) {
+      V v0, v1;
+      LoadInterleaved2(d, src + x * 2, v0, v1);
+      StoreU(v0, d, planes + x);
+      StoreU(v1, d, planes + planeStride + x);
+    }
+  }
+  for (; x < width; ++x) {
+    for (int c = 0; c < components; ++c) {
+      planes[c * planeStride + x] = src[x * components + c];
+    }
+  }
+}
 
-        for (int c = 0; c < components; ++c) {
-          float c1 = castU16(row1[x1 * components + c]);
-          float c2 = castU16(row1[x2 * components + c]);
-          float c3 = castU16(row2[x1 * components + c]);
-          float c4 = castU16(row2[x2 * components + c]);
-          float result = blerp(c1, c2, c3, c4, dx, dy);
-          dst16[x * components + c] = half(result).data_;
-        }
+template<typename T>
+void InterleaveRow(const T *planes, const size_t planeStride, T *dst,
+                   const int width, const int components) {
+  if (components == 1) {
+    memcpy(dst, planes, sizeof(T) * width);
+    return;
+  }
+  const ScalableTag<T> d;
+  const int lanes = static_cast<int>(Lanes(d));
+  int x = 0;
+  if (components == 4) {
+    for (; x + lanes <= width; x += lanes) {
+      StoreInterleaved4(LoadU(d, planes + x), LoadU(d, planes + planeStride + x),
+                        LoadU(d, planes + planeStride * 2 + x), LoadU(d, planes + planeStride * 3 + x),
+                        d, dst + x * 4);
+    }
+  } else if (components == 3) {
+    for (; x + lanes <= width; x += lanes) {
+      StoreInterleaved3(LoadU(d, planes + x), LoadU(d, planes + planeStride + x),
+                        LoadU(d, planes + planeStride * 2 + x), d, dst + x * 3);
+    }
+  } else if (components == 2) {
+    for (; x + lanes <= width; x += lanes) {
+      StoreInterleaved2(LoadU(d, planes + x), LoadU(d, planes + planeStride + x), d, dst + x * 2);
+    }
+  }
+  for (; x < width; ++x) {
+    for (int c = 0; c < components; ++c) {
+      dst[x * components + c] = planes[c * planeStride + x];
+    }
+  }
+}
+
+/**
+ * Maps a plane with values in [0, scale] through a transfer table, results keep the same range.
+ * Vectors holding samples outside of it, which only floats have, take the scalar curve so
+ * extended tables don't clamp them.
+ */
+void ApplyTransferPlane(float *plane, const int count, const TransferLut &lut, const float scale) {
+  const ScalableTag<float32_t> df;
+  const RebindToSigned<decltype(df)> di;
+  const int lanes = static_cast<int>(Lanes(df));
+  const float *table = lut.table.data();
+  const auto toIndex = Set(df, static_cast<float>(lut.size) / scale);
+  const auto maxIndex = Set(df, static_cast<float>(lut.size));
+  const auto scaleV = Set(df, scale);
+  const auto zeros = Zero(df);
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    const auto unclamped = Mul(LoadU(df, plane + i), toIndex);
+    const auto position = Min(Max(unclamped, zeros), maxIndex);
+    if (lut.extended && !AllTrue(df, Eq(position, unclamped))) {
+      for (int k = i; k < i + lanes; ++k) {
+        plane[k] = lut.apply(plane[k] / scale) * scale;
       }
-    } else if (option == cubic || option == mitchell || option == bSpline ||
-        option == catmullRom || option == hermite || option == bicubic) {
-      if (components == 4 && x + 8 < outputWidth &&
-          (option == hermite || option == mitchell || option == catmullRom ||
-              option == bSpline || option == cubic || option == bicubic)) {
-        int a = 2;
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        VF4 color = Set(dfx4, 0);
-
-        const int appendixLow[4] = {-1, 0, 1, 2};
-
-        const VF4 aVector = Set(dfx4, a);
-        VF4 srcXV = Set(dfx4, srcX);
-        VI4 kx1V = Set(dix4, kx1);
-        const VI4 appendixLowV = LoadU(dix4, appendixLow);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight = SampleOptionResult(dy, option);
-          auto row = reinterpret_cast<const uint16_t *>(src8 +
-              clamp(yj, 0,
-                    inputHeight - 1) *
-                  srcStride);
-          VF4 yWeightV = Set(dfx4, yWeight);
-          VI4 xi = Add(kx1V, appendixLowV);
-          VF4 dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          VF4 weights = Mul(SampleOptionResult(dfx4, dx, option), yWeightV);
-
-          for (int i = 0; i < 4; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VF16x4 r1 = LoadU(df16x4,
-                              reinterpret_cast<const float16_t *>(&row[sizeXPos]));
-            VF4 fr1 = PromoteTo(dfx4, r1);
-            fr1 = Mul(fr1, Set(dfx4, ExtractLane(weights, i)));
-            color = Add(color, fr1);
-          }
-        }
+      continue;
+    }
+    const auto base = Floor(position);
+    const auto index = ConvertTo(di, base);
+    const auto low = GatherIndex(df, table, index);
+    const auto high = GatherIndex(df, table + 1, index);
+    const auto value = MulAdd(Sub(high, low), Sub(position, base), low);
+    StoreU(Mul(value, scaleV), df, plane + i);
+  }
+  for (; i < count; ++i) {
+    plane[i] = lut.apply(plane[i] / scale) * scale;
+  }
+}
 
-        VF16x4 f16Color = DemoteTo(df16x4, color);
-        StoreU(f16Color, df16x4,
-               reinterpret_cast<float16_t *>(&dst16[x * components]));
-      } else {
-        int a = 2;
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight = SampleOptionResult(dy, option);
-          for (int i = -a + 1; i <= a; i++) {
-            int xi = (int) kx1 + i;
-            float dx = float(srcX) - (float(kx1) + (float) i);
-            float weight = SampleOptionResult(dx, option) * yWeight;
-
-            auto row = reinterpret_cast<const uint16_t *>(src8 +
-                clamp(yj, 0,
-                      inputHeight - 1) *
-                    srcStride);
-
-            for (int c = 0; c < components; ++c) {
-              half clrf = castU16(
-                  row[clamp(xi, 0, inputWidth - 1) * components + c]);
-              float clr = (float) clrf * weight;
-              rgb[c] += clr;
-            }
-          }
-        }
+/**
+ * Multiplies colour planes by the alpha plane that follows them, alphaScale is the opaque alpha value
+ */
+void PremultiplyPlanes(float *planes, const size_t planeStride, const int colorPlanes,
+                       const int count, const float alphaScale) {
+  const ScalableTag<float32_t> df;
+  const int lanes = static_cast<int>(Lanes(df));
+  const float *alpha = planes + colorPlanes * planeStride;
+  const float alphaFactor = 1.f / alphaScale;
+  for (int c = 0; c < colorPlanes; ++c) {
+    float *plane = planes + c * planeStride;
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) {
+      const auto factor = Mul(LoadU(df, alpha + i), Set(df, alphaFactor));
+      StoreU(Mul(LoadU(df, plane + i), factor), df, plane + i);
+    }
+    for (; i < count; ++i) {
+      plane[i] *= alpha[i] * alphaFactor;
+    }
+  }
+}
 
-        for (int c = 0; c < components; ++c) {
-          dst16[x * components + c] = half(rgb[c]).data_;
-        }
-      }
-    } else if (option == lanczos || option == hann) {
-      if (x + 8 < outputWidth && components == 4) {
-        auto lanczosFA = float(3.0f);
-        int a = 3;
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        float kWeightSum = 0;
-        VF4 color = Set(dfx4, 0);
-
-        const int appendixLow[4] = {-2, -1, 0, 1};
-        const int appendixHigh[4] = {2, 3, 0, 0};
-
-        const VF4 aVector = Set(dfx4, a);
-        VF4 srcXV = Set(dfx4, srcX);
-        VI4 kx1V = Set(dix4, kx1);
-        const VI4 appendixLowV = LoadU(dix4, appendixLow);
-        const VI4 appendixHighV = LoadU(dix4, appendixHigh);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight;
-          if (option == lanczos) {
-            yWeight = LanczosWindow(dy, lanczosFA);
-          } else {
-            yWeight = Hann(float(j), lanczosFA);
-          }
-          auto row = reinterpret_cast<const uint16_t *>(src8 +
-              clamp(yj, 0,
-                    inputHeight - 1) *
-                  srcStride);
-          VF4 yWeightV = Set(dfx4, yWeight);
-          VI4 xi = Add(kx1V, appendixLowV);
-          VF4 dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          VF4 sampleParameter = dx;
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixLowV);
-          }
-          VF4 weights = Mul(SampleOptionResult(dfx4, sampleParameter, option),
-                            yWeightV);
-          kWeightSum += ExtractLane(SumOfLanes(dfx4, weights), 0);
-          for (int i = 0; i < 4; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VF16x4 r1 = LoadU(df16x4,
-                              reinterpret_cast<const float16_t *>(&row[sizeXPos]));
-            VF4 fr1 = PromoteTo(dfx4, r1);
-            fr1 = Mul(fr1, Set(dfx4, ExtractLane(weights, i)));
-            color = Add(color, fr1);
-          }
-
-          xi = Add(kx1V, appendixHighV);
-          dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          sampleParameter = dx;
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixLowV);
-          }
-          weights = Mul(SampleOptionResult(dfx4, sampleParameter, option), yWeightV);
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixHighV);
-          }
-          for (int i = 0; i < 2; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VF16x4 r1 = LoadU(df16x4,
-                              reinterpret_cast<const float16_t *>(&row[sizeXPos]));
-            VF4 fr1 = PromoteTo(dfx4, r1);
-            float weight = ExtractLane(weights, i);
-            kWeightSum += weight;
-            fr1 = Mul(fr1, Set(dfx4, weight));
-            color = Add(color, fr1);
-          }
-        }
+/**
+ * Divides colour planes by alpha, fully transparent pixels get zero colour
+ */
+void UnpremultiplyPlanes(float *planes, const size_t planeStride, const int colorPlanes,
+                         const int count, const float alphaScale) {
+  const ScalableTag<float32_t> df;
+  const int lanes = static_cast<int>(Lanes(df));
+  const float *alpha = planes + colorPlanes * planeStride;
+  const auto zeros = Zero(df);
+  const auto alphaScaleV = Set(df, alphaScale);
+  for (int c = 0; c < colorPlanes; ++c) {
+    float *plane = planes + c * planeStride;
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) {
+      const auto a = LoadU(df, alpha + i);
+      const auto value = Div(Mul(LoadU(df, plane + i), alphaScaleV), a);
+      StoreU(IfThenElseZero(Gt(a, zeros), value), df, plane + i);
+    }
+    for (; i < count; ++i) {
+      plane[i] = alpha[i] > 0.f ? plane[i] * alphaScale / alpha[i] : 0.f;
+    }
+  }
+}
 
-        if (kWeightSum == 0) {
-          VF16x4 f16Color = DemoteTo(df16x4, color);
-          StoreU(f16Color, df16x4,
-                 reinterpret_cast<float16_t *>(&dst16[x * components]));
-        } else {
-          VF16x4 f16Color = DemoteTo(df16x4, Div(color, Set(dfx4, kWeightSum)));
-          StoreU(f16Color, df16x4,
-                 reinterpret_cast<float16_t *>(&dst16[x * components]));
-        }
-      } else {
-        auto lanczosFA = float(3.0f);
-        int a = 3;
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        float weightSum(0.0f);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight;
-          if (option == lanczos) {
-            yWeight = LanczosWindow(dy, lanczosFA);
-          } else {
-            yWeight = Hann(float(j), lanczosFA);
-          }
-          for (int i = -a + 1; i <= a; i++) {
-            int xi = (int) kx1 + i;
-            float dx = float(srcX) - (float(kx1) + (float) i);
-            float weight;
-            if (option == lanczos) {
-              weight = LanczosWindow(dx, lanczosFA) * yWeight;
-            } else {
-              weight = Hann(float(i), lanczosFA) * yWeight;
-            }
-            weightSum += weight;
-
-            auto row = reinterpret_cast<const uint16_t *>(src8 +
-                clamp(yj, 0,
-                      inputHeight - 1) *
-                    srcStride);
-
-            for (int c = 0; c < components; ++c) {
-              half clrf = castU16(
-                  row[clamp(xi, 0, inputWidth - 1) * components + c]);
-              float clr = (float) clrf * weight;
-              rgb[c] += clr;
-            }
-          }
-        }
+/**
+ * Kernel overshoot may leave premultiplied colours above alpha, those are clipped back to it
+ */
+void ClampPlanesToAlpha(float *planes, const size_t planeStride, const int colorPlanes, const int count) {
+  const ScalableTag<float32_t> df;
+  const int lanes = static_cast<int>(Lanes(df));
+  const float *alpha = planes + colorPlanes * planeStride;
+  for (int c = 0; c < colorPlanes; ++c) {
+    float *plane = planes + c * planeStride;
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) {
+      StoreU(Min(LoadU(df, plane + i), LoadU(df, alpha + i)), df, plane + i);
+    }
+    for (; i < count; ++i) {
+      plane[i] = min(plane[i], alpha[i]);
+    }
+  }
+}
 
-        for (int c = 0; c < components; ++c) {
-          if (weightSum == 0) {
-            dst16[x * components + c] = half(rgb[c]).data_;
-          } else {
-            dst16[x * components + c] = half(rgb[c] / weightSum).data_;
-          }
-        }
-      }
-    } else {
-      auto row = reinterpret_cast<const uint16_t *>(src8 + y1 * srcStride);
-      memcpy(&dst16[x * components], &row[x1 * components],
-             sizeof(uint16_t) * components);
+/**
+ * Adds up the lanes of the tap sums of kCount destinations starting at x, lane i of the result
+ * is the sum of destination x + i. Pairs are folded with ConcatEven and ConcatOdd, so kCount
+ * must equal the lanes of d.
+ */
+template<int kCount, class D, class TapSum>
+HWY_INLINE Vec<D> SumOfGroup(const D d, const TapSum &tapSum, const int x) {
+  if constexpr (kCount == 1) {
+    return tapSum(x);
+  } else {
+    const auto lower = SumOfGroup<kCount / 2>(d, tapSum, x);
+    const auto upper = SumOfGroup<kCount / 2>(d, tapSum, x + kCount / 2);
+    return Add(ConcatEven(d, upper, lower), ConcatOdd(d, upper, lower));
+  }
+}
+
+/**
+ * Convolves columns [from, to) of one plane of srcWidth samples whose first one is source column srcOffset.
+ * Taps of a destination sample are contiguous, so they are read with plain vector loads at its start
+ * column and a vector of destinations is reduced at once. Every sample is summed in the same order
+ * wherever it falls, so a window matches the same pixels of the full image exactly
+ */
+template<int kLanes, class D>
+void FilterPlaneHorizontalLanes(const D df, const float *src, const int srcOffset, const int srcWidth,
+                                float *dst, const PaddedWeights<float> &weights, const int from, const int to) {
+  const int taps = weights.taps;
+  const float *table = weights.weights.data();
+  std::vector<float> window;
+  auto tapSum = [&](const int x) {
+    const int first = weights.start[x] - srcOffset;
+    const float *source = src + first;
+    if (first + taps > srcWidth) {
+      // Padding would read past the plane, zero weighted taps get zero samples instead
+      window.assign(taps, 0.f);
+      std::copy(source, src + srcWidth, window.begin());
+      source = window.data();
+    }
+    const float *row = table + static_cast<size_t>(x) * taps;
+    auto sum = Mul(LoadU(df, source), LoadU(df, row));
+    for (int k = kLanes; k < taps; k += kLanes) {
+      sum = MulAdd(LoadU(df, source + k), LoadU(df, row + k), sum);
+    }
+    return sum;
+  };
+  int x = from;
+  for (; x + kLanes <= to; x += kLanes) {
+    StoreU(SumOfGroup<kLanes>(df, tapSum, x), df, dst + x - from);
+  }
+  if (x < to) {
+    auto tailSum = [&](const int i) {
+      return i < to ? tapSum(i) : Zero(df);
+    };
+    float sums[kLanes];
+    StoreU(SumOfGroup<kLanes>(df, tailSum, x), df, sums);
+    std::copy(sums, sums + (to - x), dst + x - from);
+  }
+}
+
+void FilterPlaneHorizontal(const float *src, const int srcOffset, const int srcWidth, float *dst,
+                           const PaddedWeights<float> &weights, const int from, const int to) {
+  if (weights.lanes >= 16) {
+    FilterPlaneHorizontalLanes<16>(CappedTag<float32_t, 16>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  } else if (weights.lanes >= 8) {
+    FilterPlaneHorizontalLanes<8>(CappedTag<float32_t, 8>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  } else {
+    FilterPlaneHorizontalLanes<4>(FixedTag<float32_t, 4>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  }
+}
+
+/**
+ * Sums taps rows with their weights
+ */
+void FilterRowsVertical(const float *const *rows, const float *weights, const int taps,
+                        float *dst, const int count) {
+  const ScalableTag<float32_t> df;
+  const int lanes = static_cast<int>(Lanes(df));
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    auto sum = Zero(df);
+    for (int k = 0; k < taps; ++k) {
+      sum = MulAdd(LoadU(df, rows[k] + i), Set(df, weights[k]), sum);
+    }
+    StoreU(sum, df, dst + i);
+  }
+  for (; i < count; ++i) {
+    float sum = 0.f;
+    for (int k = 0; k < taps; ++k) {
+      sum += rows[k][i] * weights[k];
+    }
+    dst[i] = sum;
+  }
+}
+
+template<typename T>
+void ScaleNearestRow(const T *src, T *dst, const ResampleWeights &horizontal, const int components) {
+  for (int x = 0; x < horizontal.dstSize; ++x) {
+    memcpy(&dst[x * components], &src[horizontal.start[x] * components], sizeof(T) * components);
+  }
+}
+
+// Bytes of horizontally filtered rows one tile keeps alive, about the L2 size of mobile cores
+constexpr size_t kTileCacheBytes = 256 * 1024;
+// Upper bound of output rows per tile, taller tiles amortise the kernel overlap with their neighbours
+constexpr int kTileRows = 64;
+
+/**
+ * Output is split into tiles of stripWidth columns by bandHeight rows that are resampled independently.
+ * A tile filters only the source columns under its strip, and keeps just the taps horizontally filtered rows
+ * its current output row reads in a ring, so scratch memory doesn't grow with the image height.
+ */
+struct TileLayout {
+  int stripWidth;
+  int strips;
+  int bandHeight;
+  int bands;
+  // Widest source span read by a strip
+  int maxSourceSpan;
+
+  int count() const {
+    return strips * bands;
+  }
+};
+
+template<class Table>
+TileLayout PlanTiles(const Table &horizontal, const Table &vertical, const int components,
+                     const size_t sampleSize, const int threadCount) {
+  TileLayout layout;
+  const int width = horizontal.dstSize;
+  const int height = vertical.dstSize;
+  const size_t ringRowBytes = static_cast<size_t>(vertical.taps) * components * sampleSize;
+  const int cachedWidth = max(static_cast<int>(kTileCacheBytes / ringRowBytes) / 16 * 16, 64);
+  layout.strips = max((width + cachedWidth - 1) / cachedWidth, 1);
+  layout.stripWidth = (width + layout.strips - 1) / layout.strips;
+  layout.bandHeight = clamp((height + threadCount - 1) / threadCount, 1, kTileRows);
+  layout.bands = (height + layout.bandHeight - 1) / layout.bandHeight;
+  layout.maxSourceSpan = 0;
+  for (int strip = 0; strip < layout.strips; ++strip) {
+    const int from = strip * layout.stripWidth;
+    const int to = min(from + layout.stripWidth, width);
+    layout.maxSourceSpan = max(layout.maxSourceSpan,
+                               horizontal.start[to - 1] + horizontal.taps - horizontal.start[from]);
+  }
+  return layout;
+}
+
+/**
+ * Walks output rows [from, to) of a tile. Every source row entering the kernel window is passed once to
+ * filterRow(sourceY, ringRow), then emitRow(y, rows) gets the taps ring rows of output row y in order.
+ * Windows only move forward, so a ring of taps rows never overwrites a row that is still read.
+ */
+template<class Table, typename R, class FilterRow, class EmitRow>
+void RunTileRows(const Table &vertical, R *ring, const size_t ringStride, const R **rows,
+                 const int from, const int to, FilterRow &&filterRow, EmitRow &&emitRow) {
+  const int taps = vertical.taps;
+  int nextRow = vertical.start[from];
+  for (int y = from; y < to; ++y) {
+    const int first = vertical.start[y];
+    nextRow = max(nextRow, first);
+    for (; nextRow < first + taps; ++nextRow) {
+      filterRow(nextRow, ring + static_cast<size_t>(nextRow % taps) * ringStride);
+    }
+    for (int k = 0; k < taps; ++k) {
+      rows[k] = ring + static_cast<size_t>((first + k) % taps) * ringStride;
+    }
+    emitRow(y, rows);
+  }
+}
+
+/**
+ * Resizes horizontally then vertically, kernel weights are computed once per column and per row
+ * instead of for every output pixel. Reduced axes stretch the kernel support by the downscale factor,
+ * so every source sample contributes at any ratio.
+ * Rows are filtered channel planar: horizontally a vector holds consecutive taps of one destination
+ * sample, vertically consecutive samples of one channel.
+ * Only the window of the scaled image described by the plan is produced, output holds just
+ * those pixels, and source rows and columns outside its kernel support are never touched.
+ * With linearLight colour planes are decoded from sRGB right after loading and encoded back before
+ * the store, so filtering happens in linear light without separate passes over the image.
+ * Straight alpha is premultiplied the same way, after linearisation and undone before encoding.
+ */
+template<typename T>
+void ScaleImageSeparable(const uint8_t *src8, const int srcStride,
+                         uint8_t *dst8, const int dstStride,
+                         const int components, const float maxColors, const bool linearLight,
+                         const XAlphaMode alphaMode, const ResizePlan &plan) {
+  const int windowWidth = plan.key.windowWidth;
+  const int windowHeight = plan.key.windowHeight;
+  const ResampleWeights &horizontal = plan.horizontal;
+  const ResampleWeights &vertical = plan.vertical;
+  const int threadCount = 6;
+
+  if (plan.key.sampler == nearest) {
+    concurrency::parallel_for(threadCount, windowHeight, [&](int y) {
+      ScaleNearestRow(reinterpret_cast<const T *>(src8 + vertical.start[y] * srcStride),
+                      reinterpret_cast<T *>(dst8 + y * dstStride), horizontal, components);
+    });
+    return;
+  }
+
+  const PaddedWeights<float> &paddedHorizontal = plan.paddedHorizontal;
+  // 8 bit samples are filtered in [0, maxColors], half floats in [0, 1]
+  const float transferScale = std::is_same_v<T, uint8_t> ? maxColors : 1.f;
+  const int colorPlanes = TransferChannels(components);
+  const int transferPlanes = linearLight ? colorPlanes : 0;
+  const bool premultiply = alphaMode != alphaAsIs && colorPlanes < components;
+  const bool emitPremultiplied = premultiply && alphaMode == alphaPremultiplyOutput;
+  // Linear values are divided back before encoding and premultiplied again after it
+  const bool unpremultiply = premultiply && (!emitPremultiplied || linearLight);
+
+  const TileLayout tiles = PlanTiles(horizontal, vertical, components, sizeof(float), threadCount);
+  const int tileThreads = min(threadCount, tiles.count());
+  const int sourceLength = tiles.maxSourceSpan * components;
+  const size_t ringStride = static_cast<size_t>(tiles.stripWidth) * components;
+  std::vector<std::vector<float>> sourceRows(tileThreads, std::vector<float>(sourceLength * 2));
+  std::vector<std::vector<float>> rings(tileThreads, std::vector<float>(ringStride * vertical.taps));
+  std::vector<std::vector<const float *>> ringRows(tileThreads, std::vector<const float *>(vertical.taps));
+  std::vector<std::vector<float>> dstRows(tileThreads, std::vector<float>(ringStride * 2));
+
+  concurrency::parallel_for_with_thread_id(tileThreads, tiles.count(), [&](int threadId, int tile) {
+    const int x0 = (tile % tiles.strips) * tiles.stripWidth;
+    const int x1 = min(x0 + tiles.stripWidth, windowWidth);
+    const int y0 = (tile / tiles.strips) * tiles.bandHeight;
+    const int y1 = min(y0 + tiles.bandHeight, windowHeight);
+    const int tileWidth = x1 - x0;
+    const int sourceX = horizontal.start[x0];
+    const int sourceWidth = horizontal.start[x1 - 1] + horizontal.taps - sourceX;
+    float *sourceRow = sourceRows[threadId].data();
+    float *sourcePlanes = sourceRow + sourceLength;
+    float *dstPlanes = dstRows[threadId].data();
+    float *dstRow = dstPlanes + ringStride;
+
+    RunTileRows(vertical, rings[threadId].data(), ringStride, ringRows[threadId].data(), y0, y1,
+                [&](int sourceY, float *ringRow) {
+                  auto src = reinterpret_cast<const T *>(src8 + sourceY * srcStride) + sourceX * components;
+                  PromoteRowF32(src, sourceRow, sourceWidth * components);
+                  DeinterleaveRow(sourceRow, sourcePlanes, sourceWidth, sourceWidth, components);
+                  for (int c = 0; c < transferPlanes; ++c) {
+                    ApplyTransferPlane(sourcePlanes + c * sourceWidth, sourceWidth,
+                                       SRGBToLinearLut(), transferScale);
+                  }
+                  if (premultiply) {
+                    PremultiplyPlanes(sourcePlanes, sourceWidth, colorPlanes, sourceWidth, transferScale);
+                  }
+                  for (int c = 0; c < components; ++c) {
+                    FilterPlaneHorizontal(sourcePlanes + c * sourceWidth, sourceX, sourceWidth,
+                                          ringRow + c * tileWidth, paddedHorizontal, x0, x1);
+                  }
+                },
+                [&](int y, const float *const *rows) {
+                  FilterRowsVertical(rows, vertical.weights.data() + static_cast<size_t>(y) * vertical.taps,
+                                     vertical.taps, dstPlanes, tileWidth * components);
+                  if (unpremultiply) {
+                    UnpremultiplyPlanes(dstPlanes, tileWidth, colorPlanes, tileWidth, transferScale);
+                  }
+                  for (int c = 0; c < transferPlanes; ++c) {
+                    ApplyTransferPlane(dstPlanes + c * tileWidth, tileWidth, LinearToSRGBLut(), transferScale);
+                  }
+                  if (emitPremultiplied) {
+                    if (unpremultiply) {
+                      PremultiplyPlanes(dstPlanes, tileWidth, colorPlanes, tileWidth, transferScale);
+                    }
+                    ClampPlanesToAlpha(dstPlanes, tileWidth, colorPlanes, tileWidth);
+                  }
+                  InterleaveRow(dstPlanes, tileWidth, dstRow, tileWidth, components);
+                  StoreRow(dstRow, reinterpret_cast<T *>(dst8 + y * dstStride) + x0 * components,
+                           tileWidth * components, maxColors);
+                });
+  });
+}
+
+// Fractional bits kept in the 16 bit intermediate rows of the fixed point path
+constexpr int kIntermediateBits = 6;
+
+template<int kLanes, class D>
+void FilterPlaneHorizontalQ14Lanes(const D di, const int32_t *src, const int srcOffset, const int srcWidth,
+                                   int16_t *dst, const PaddedWeights<int32_t> &weights,
+                                   const int from, const int to) {
+  constexpr int shift = kResampleWeightsBits - kIntermediateBits;
+  constexpr int32_t rounding = 1 << (shift - 1);
+  const Rebind<int16_t, D> di16;
+  const int taps = weights.taps;
+  const int32_t *table = weights.weights.data();
+  const auto roundingV = Set(di, rounding);
+  std::vector<int32_t> window;
+  auto tapSum = [&](const int x) {
+    const int first = weights.start[x] - srcOffset;
+    const int32_t *source = src + first;
+    if (first + taps > srcWidth) {
+      window.assign(taps, 0);
+      std::copy(source, src + srcWidth, window.begin());
+      source = window.data();
+    }
+    const int32_t *row = table + static_cast<size_t>(x) * taps;
+    auto sum = Mul(LoadU(di, source), LoadU(di, row));
+    for (int k = kLanes; k < taps; k += kLanes) {
+      sum = Add(sum, Mul(LoadU(di, source + k), LoadU(di, row + k)));
+    }
+    return sum;
+  };
+  int x = from;
+  for (; x + kLanes <= to; x += kLanes) {
+    const auto sum = Add(SumOfGroup<kLanes>(di, tapSum, x), roundingV);
+    StoreU(DemoteTo(di16, ShiftRight<shift>(sum)), di16, dst + x - from);
+  }
+  if (x < to) {
+    auto tailSum = [&](const int i) {
+      return i < to ? tapSum(i) : Zero(di);
+    };
+    const auto sum = Add(SumOfGroup<kLanes>(di, tailSum, x), roundingV);
+    int16_t sums[kLanes];
+    StoreU(DemoteTo(di16, ShiftRight<shift>(sum)), di16, sums);
+    std::copy(sums, sums + (to - x), dst + x - from);
+  }
+}
+
+void FilterPlaneHorizontalQ14(const int32_t *src, const int srcOffset, const int srcWidth, int16_t *dst,
+                              const PaddedWeights<int32_t> &weights, const int from, const int to) {
+  if (weights.lanes >= 16) {
+    FilterPlaneHorizontalQ14Lanes<16>(CappedTag<int32_t, 16>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  } else if (weights.lanes >= 8) {
+    FilterPlaneHorizontalQ14Lanes<8>(CappedTag<int32_t, 8>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  } else {
+    FilterPlaneHorizontalQ14Lanes<4>(FixedTag<int32_t, 4>(), src, srcOffset, srcWidth, dst, weights, from, to);
+  }
+}
+
+void FilterRowsVerticalQ14(const int16_t *const *rows, const int16_t *weights, const int taps,
+                           uint8_t *dst, const int count) {
+  constexpr int shift = kResampleWeightsBits + kIntermediateBits;
+  constexpr int32_t rounding = 1 << (shift - 1);
+  const ScalableTag<int32_t> di;
+  const Rebind<int16_t, decltype(di)> di16;
+  const Rebind<uint8_t, decltype(di)> du8;
+  const int lanes = static_cast<int>(Lanes(di));
+  const auto roundingV = Set(di, rounding);
+  int i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    auto sum = roundingV;
+    for (int k = 0; k < taps; ++k) {
+      sum = Add(sum, Mul(PromoteTo(di, LoadU(di16, rows[k] + i)), Set(di, weights[k])));
     }
+    StoreU(DemoteTo(du8, ShiftRight<shift>(sum)), du8, dst + i);
+  }
+  for (; i < count; ++i) {
+    int32_t sum = rounding;
+    for (int k = 0; k < taps; ++k) {
+      sum += static_cast<int32_t>(rows[k][i]) * weights[k];
+    }
+    dst[i] = static_cast<uint8_t>(clamp(sum >> shift, 0, 255));
   }
 }
 
+/**
+ * 8 bit variant of ScaleImageSeparable in fixed point: 14 bit weights, 16 bit intermediate rows
+ * and 32 bit accumulators, results stay within one step of the float path.
+ */
+void ScaleImageSeparableQ14(const uint8_t *src8, const int srcStride,
+                            uint8_t *dst8, const int dstStride,
+                            const int components, const ResizePlan &plan) {
+  const int windowWidth = plan.key.windowWidth;
+  const int windowHeight = plan.key.windowHeight;
+  const ResampleWeightsQ14 &horizontal = plan.horizontalQ14;
+  const ResampleWeightsQ14 &vertical = plan.verticalQ14;
+  const PaddedWeights<int32_t> &paddedHorizontal = plan.paddedHorizontalQ14;
+  const int threadCount = 6;
+
+  const TileLayout tiles = PlanTiles(horizontal, vertical, components, sizeof(int16_t), threadCount);
+  const int tileThreads = min(threadCount, tiles.count());
+  const int sourceLength = tiles.maxSourceSpan * components;
+  const size_t ringStride = static_cast<size_t>(tiles.stripWidth) * components;
+  std::vector<std::vector<int32_t>> sourceRows(tileThreads, std::vector<int32_t>(sourceLength * 2));
+  std::vector<std::vector<int16_t>> rings(tileThreads, std::vector<int16_t>(ringStride * vertical.taps));
+  std::vector<std::vector<const int16_t *>> ringRows(tileThreads, std::vector<const int16_t *>(vertical.taps));
+  std::vector<std::vector<uint8_t>> dstRows(tileThreads, std::vector<uint8_t>(ringStride));
+
+  concurrency::parallel_for_with_thread_id(tileThreads, tiles.count(), [&](int threadId, int tile) {
+    const int x0 = (tile % tiles.strips) * tiles.stripWidth;
+    const int x1 = min(x0 + tiles.stripWidth, windowWidth);
+    const int y0 = (tile / tiles.strips) * tiles.bandHeight;
+    const int y1 = min(y0 + tiles.bandHeight, windowHeight);
+    const int tileWidth = x1 - x0;
+    const int sourceX = horizontal.start[x0];
+    const int sourceWidth = horizontal.start[x1 - 1] + horizontal.taps - sourceX;
+    int32_t *sourceRow = sourceRows[threadId].data();
+    int32_t *sourcePlanes = sourceRow + sourceLength;
+    uint8_t *dstPlanes = dstRows[threadId].data();
+
+    RunTileRows(vertical, rings[threadId].data(), ringStride, ringRows[threadId].data(), y0, y1,
+                [&](int sourceY, int16_t *ringRow) {
+                  PromoteRowI32(src8 + sourceY * srcStride + sourceX * components, sourceRow,
+                                sourceWidth * components);
+                  DeinterleaveRow(sourceRow, sourcePlanes, sourceWidth, sourceWidth, components);
+                  for (int c = 0; c < components; ++c) {
+                    FilterPlaneHorizontalQ14(sourcePlanes + c * sourceWidth, sourceX, sourceWidth,
+                                             ringRow + c * tileWidth, paddedHorizontal, x0, x1);
+                  }
+                },
+                [&](int y, const int16_t *const *rows) {
+                  FilterRowsVerticalQ14(rows, vertical.weights.data() + static_cast<size_t>(y) * vertical.taps,
+                                        vertical.taps, dstPlanes, tileWidth * components);
+                  InterleaveRow(dstPlanes, tileWidth, dst8 + y * dstStride + x0 * components,
+                                tileWidth, components);
+                });
+  });
+}
+
 void scaleImageFloat16HWY(const uint16_t *input,
                           int srcStride,
-                          int inputWidth, int inputHeight,
                           uint16_t *output,
                           int dstStride,
-                          int outputWidth, int outputHeight,
                           int components,
-                          XSampler option) {
-  float xScale = static_cast<float>(inputWidth) / static_cast<float>(outputWidth);
-  float yScale = static_cast<float>(inputHeight) / static_cast<float>(outputHeight);
-
-  auto src8 = reinterpret_cast<const uint8_t *>(input);
-
-  concurrency::parallel_for(6, outputHeight, [&](int y) {
-    scaleRowF16(src8, srcStride, dstStride, inputWidth, inputHeight,
-                output, outputWidth,
-                xScale, option, yScale, y, components);
-  });
+                          bool linearLight, XAlphaMode alphaMode,
+                          const ResizePlan &plan) {
+  ScaleImageSeparable<uint16_t>(reinterpret_cast<const uint8_t *>(input), srcStride,
+                                reinterpret_cast<uint8_t *>(output), dstStride,
+                                components, 0.f, linearLight, alphaMode, plan);
 }
 
-void
-ScaleRowU8(const uint8_t *src8,
-           const int srcStride,
-           int inputWidth, int inputHeight, uint8_t *output,
-           const int dstStride,
-           int outputWidth,
-           const int components,
-           const XSampler option,
-           float xScale,
-           float yScale,
-           float maxColors,
-           int y) {
-  auto dst8 = reinterpret_cast<uint8_t *>(output + y * dstStride);
-  auto dst = reinterpret_cast<uint8_t *>(dst8);
-
-  const FixedTag<float32_t, 4> dfx4;
-  const FixedTag<int32_t, 4> dix4;
-  const FixedTag<uint32_t, 4> dux4;
-  const FixedTag<uint8_t, 4> du8x4;
-  using VI4 = Vec<decltype(dix4)>;
-  using VF4 = Vec<decltype(dfx4)>;
-  using VU8x4 = Vec<decltype(du8x4)>;
-
-  const int shift[4] = {0, 1, 2, 3};
-  const VI4 shiftV = LoadU(dix4, shift);
-  const VF4 xScaleV = Set(dfx4, xScale);
-  const VF4 yScaleV = Set(dfx4, yScale);
-  const VI4 addOne = Set(dix4, 1);
-  const VF4 fOneV = Set(dfx4, 1.0f);
-  const VI4 maxWidth = Set(dix4, inputWidth - 1);
-  const VI4 maxHeight = Set(dix4, inputHeight - 1);
-  const VI4 iZeros = Zero(dix4);
-  const VF4 vfZeros = Zero(dfx4);
-  const VI4 srcStrideV = Set(dix4, srcStride);
-  const VF4 maxColorsV = Set(dfx4, maxColors);
-
-  for (int x = 0; x < outputWidth; ++x) {
-    float srcX = (float) x * xScale;
-    float srcY = (float) y * yScale;
-
-    int x1 = static_cast<int>(srcX);
-    int y1 = static_cast<int>(srcY);
-
-    if (option == bilinear) {
-      if (components == 4 && x + 8 < outputWidth) {
-        VI4 currentX = Set(dix4, x);
-        VI4 currentXV = Add(currentX, shiftV);
-        VF4 currentXVF = Mul(ConvertTo(dfx4, currentXV), xScaleV);
-        VF4 currentYVF = Mul(ConvertTo(dfx4, Set(dix4, y)), yScaleV);
-
-        VI4 xi1 = ConvertTo(dix4, Floor(currentXVF));
-        VI4 yi1 = Min(ConvertTo(dix4, Floor(currentYVF)), maxHeight);
-
-        VI4 xi2 = Min(Add(xi1, addOne), maxWidth);
-        VI4 yi2 = Min(Add(yi1, addOne), maxHeight);
-
-        VF4 dx = Max(Sub(currentXVF, ConvertTo(dfx4, xi1)), vfZeros);
-        VF4 dy = Max(Sub(currentYVF, ConvertTo(dfx4, yi1)), vfZeros);
-
-        VI4 row1Add = Mul(yi1, srcStrideV);
-        VI4 row2Add = Mul(yi2, srcStrideV);
-
-        for (int i = 0; i < 4; i++) {
-          auto row1 = reinterpret_cast<const uint8_t *>(src8 +
-              ExtractLane(row1Add, i));
-          auto row2 = reinterpret_cast<const uint8_t *>(src8 +
-              ExtractLane(row2Add, i));
-
-          VU8x4 lane = LoadU(du8x4, reinterpret_cast<const uint8_t *>(&row1[
-              ExtractLane(xi1, i) * components]));
-          VF4 c1 = ConvertTo(dfx4, PromoteTo(dux4, lane));
-          lane = LoadU(du8x4,
-                       reinterpret_cast<const uint8_t *>(&row1[ExtractLane(xi2, i) *
-                           components]));
-          VF4 c2 = ConvertTo(dfx4, PromoteTo(dux4, lane));
-          lane = LoadU(du8x4,
-                       reinterpret_cast<const uint8_t *>(&row2[ExtractLane(xi1, i) *
-                           components]));
-          VF4 c3 = ConvertTo(dfx4, PromoteTo(dux4, lane));
-          lane = LoadU(du8x4,
-                       reinterpret_cast<const uint8_t *>(&row2[ExtractLane(xi2, i) *
-                           components]));
-          VF4 c4 = ConvertTo(dfx4, PromoteTo(dux4, lane));
-          VF4 value = Blerp(dfx4, c1, c2, c3, c4, Set(dfx4, ExtractLane(dx, i)),
-                            Set(dfx4, ExtractLane(dy, i)));
-          VF4 sum = ClampRound(dfx4, value, vfZeros, maxColorsV);
-          VU8x4 pixel = DemoteTo(du8x4, ConvertTo(dux4, sum));
-          auto u8Store = &dst[ExtractLane(currentXV, i) * components];
-          StoreU(pixel, du8x4, u8Store);
-        }
+void scaleImageU8HWY(const uint8_t *input,
+                     const int srcStride,
+                     uint8_t *output,
+                     const int dstStride,
+                     const int components,
+                     const int depth,
+                     bool linearLight, XAlphaMode alphaMode,
+                     const ResizePlan &plan) {
+  // Fixed point rows don't keep enough precision for linear light or for dividing by alpha
+  const bool premultiply = alphaMode != alphaAsIs && (components == 2 || components == 4);
+  if (depth == 8 && plan.key.sampler != nearest && !linearLight && !premultiply) {
+    ScaleImageSeparableQ14(input, srcStride, output, dstStride, components, plan);
+    return;
+  }
 
-        x += components - 1;
-      } else {
-        for (int c = 0; c < components; ++c) {
-          int x2 = min(x1 + 1, inputWidth - 1);
-          int y2 = min(y1 + 1, inputHeight - 1);
+  float maxColors = std::powf(2.0f, static_cast<float>(depth)) - 1.0f;
 
-          float dx = max((float) srcX - (float) x1, 0.0f);
-          float dy = max((float) srcY - (float) y1, 0.0f);
+  ScaleImageSeparable<uint8_t>(input, srcStride, output, dstStride,
+                               components, maxColors, linearLight, alphaMode, plan);
+}
 
-          auto row1 = reinterpret_cast<const uint8_t *>(src8 + y1 * srcStride);
-          auto row2 = reinterpret_cast<const uint8_t *>(src8 + y2 * srcStride);
+/**
+ * Box reduction sums the factorY source rows of an output row column wise over full vectors,
+ * then folds groups of factorX pixels per channel
+ */
+void BoxReduceRowU8(const uint8_t *src8, const int srcStride,
+                    const int inputWidth, const int inputHeight,
+                    uint8_t *dst, const int outputWidth,
+                    const int components, const int factorX, const int factorY,
+                    const int y, uint32_t *sums) {
+  const ScalableTag<uint32_t> du32;
+  const Rebind<uint8_t, decltype(du32)> du8;
+  const int lanes = static_cast<int>(Lanes(du32));
+  const int top = y * factorY;
+  const int bottom = min(top + factorY, inputHeight);
+  const int rowLength = inputWidth * components;
+  fill(sums, sums + rowLength, 0u);
+
+  for (int sy = top; sy < bottom; ++sy) {
+    auto row = src8 + sy * srcStride;
+    int i = 0;
+    for (; i + lanes <= rowLength; i += lanes) {
+      StoreU(Add(LoadU(du32, sums + i), PromoteTo(du32, LoadU(du8, row + i))), du32, sums + i);
+    }
+    for (; i < rowLength; ++i) {
+      sums[i] += row[i];
+    }
+  }
 
-          float c1 = static_cast<float>(row1[x1 * components + c]);
-          float c2 = static_cast<float>(row1[x2 * components + c]);
-          float c3 = static_cast<float>(row2[x1 * components + c]);
-          float c4 = static_cast<float>(row2[x2 * components + c]);
+  for (int x = 0; x < outputWidth; ++x) {
+    const int left = x * factorX;
+    const int right = min(left + factorX, inputWidth);
+    const uint32_t count = (right - left) * (bottom - top);
+    for (int c = 0; c < components; ++c) {
+      uint32_t sum = 0;
+      for (int sx = left; sx < right; ++sx) {
+        sum += sums[sx * components + c];
+      }
+      dst[x * components + c] = static_cast<uint8_t>((sum + count / 2) / count);
+    }
+  }
+}
 
-          float result = blerp(c1, c2, c3, c4, dx, dy);
-          float f = result;
-          f = clamp(round(f), 0.0f, maxColors);
-          dst[x * components + c] = static_cast<uint8_t>(f);
-        }
+/**
+ * Box reduction of straight alpha pixels, colours are summed weighted by their alpha and divided
+ * by the alpha sum, or by the pixel count for premultiplied output. 64 bit sums keep boxes
+ * of any size exact
+ */
+void BoxReducePremultipliedRowU8(const uint8_t *src8, const int srcStride,
+                                 const int inputWidth, const int inputHeight,
+                                 uint8_t *dst, const int outputWidth,
+                                 const int components, const int factorX, const int factorY,
+                                 const int y, const XAlphaMode alphaMode, uint64_t *sums) {
+  const int colorChannels = TransferChannels(components);
+  const int top = y * factorY;
+  const int bottom = min(top + factorY, inputHeight);
+  fill(sums, sums + inputWidth * components, uint64_t(0));
+
+  for (int sy = top; sy < bottom; ++sy) {
+    auto row = src8 + sy * srcStride;
+    for (int x = 0; x < inputWidth; ++x) {
+      const uint8_t *pixel = row + x * components;
+      uint64_t *sum = sums + x * components;
+      const uint32_t alpha = pixel[colorChannels];
+      for (int c = 0; c < colorChannels; ++c) {
+        sum[c] += pixel[c] * alpha;
       }
-    } else if (option == cubic || option == mitchell || option == bSpline ||
-        option == catmullRom || option == hermite || option == bicubic) {
-      if (components == 4 && x + 8 < outputWidth &&
-          (option == hermite || option == mitchell || option == catmullRom ||
-              option == bSpline || option == cubic || option == bicubic)) {
-        // only kernel with size 3 is supported
-        constexpr int kernelSize = 2;
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        VF4 color = Set(dfx4, 0);
-
-        const int a = kernelSize;
-        const int mMaxHeight = inputHeight - 1;
-        const int mMaxWidth = inputWidth - 1;
-
-        const int appendixLow[4] = {-1, 0, 1, 2};
-
-        const VF4 aVector = Set(dfx4, a);
-        VF4 srcXV = Set(dfx4, srcX);
-        VI4 kx1V = Set(dix4, kx1);
-        const VI4 appendixLowV = LoadU(dix4, appendixLow);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight = SampleOptionResult(dy, option);
-          auto row = reinterpret_cast<const uint8_t *>(src8 +
-              clamp(yj, 0,
-                    inputHeight - 1) *
-                  srcStride);
-          VF4 yWeightV = Set(dfx4, yWeight);
-          VI4 xi = Add(kx1V, appendixLowV);
-          VF4 dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          VF4 weights = Mul(SampleOptionResult(dfx4, dx, option), yWeightV);
-          for (int i = 0; i < 4; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VU8x4 u81 = LoadU(du8x4,
-                              reinterpret_cast<const uint8_t *>(&row[sizeXPos]));
-            VF4 fr1 = ConvertTo(dfx4, PromoteTo(dix4, u81));
-            fr1 = Mul(fr1, Set(dfx4, ExtractLane(weights, i)));
-            color = Add(color, fr1);
-          }
-        }
+      sum[colorChannels] += alpha;
+    }
+  }
 
-        color = ClampRound(dfx4, color, vfZeros, maxColorsV);
-        VU8x4 u8Color = DemoteTo(du8x4, ConvertTo(dux4, color));
-        StoreU(u8Color, du8x4,
-               reinterpret_cast<uint8_t *>(&dst[x * components]));
+  for (int x = 0; x < outputWidth; ++x) {
+    const int left = x * factorX;
+    const int right = min(left + factorX, inputWidth);
+    const uint64_t count = (right - left) * (bottom - top);
+    uint64_t alphaSum = 0;
+    for (int sx = left; sx < right; ++sx) {
+      alphaSum += sums[sx * components + colorChannels];
+    }
+    uint8_t *out = dst + x * components;
+    for (int c = 0; c < colorChannels; ++c) {
+      uint64_t sum = 0;
+      for (int sx = left; sx < right; ++sx) {
+        sum += sums[sx * components + c];
+      }
+      if (alphaMode == alphaPremultiplyOutput) {
+        out[c] = static_cast<uint8_t>((sum + count * 255 / 2) / (count * 255));
       } else {
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        float weightSum(0.0f);
-
-        int a = 2;
-
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight = SampleOptionResult(dy, option);
-
-          auto row = reinterpret_cast<const uint8_t *>(src8 +
-              clamp(yj, 0,
-                    inputHeight - 1) *
-                  srcStride);
-
-          for (int i = -a + 1; i <= a; i++) {
-            int xi = (int) kx1 + i;
-            float dx = float(srcX) - (float(kx1) + (float) i);
-            float weight = SampleOptionResult(dx, option) * yWeight;
-            weightSum += weight;
-
-            for (int c = 0; c < components; ++c) {
-              auto clrf = static_cast<float>(row[
-                  clamp(xi, 0, inputWidth - 1) * components + c]);
-              float clr = clrf * weight;
-              rgb[c] += clr;
-            }
-          }
-        }
-
-        for (int c = 0; c < components; ++c) {
-          dst[x * components + c] = static_cast<uint8_t>(clamp(
-              round(rgb[c]),
-              0.0f, maxColors));
-        }
+        out[c] = alphaSum > 0 ? static_cast<uint8_t>((sum + alphaSum / 2) / alphaSum) : 0;
       }
-    } else if (option == lanczos || option == hann) {
-      if (x + 8 < outputWidth && components == 4) {
-        // only kernel with size 3 is supported
-        constexpr int kernelSize = 3;
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        float kWeightSum = 0;
-        VF4 color = Set(dfx4, 0);
-
-        const int a = kernelSize;
-        const int mMaxHeight = inputHeight - 1;
-        const int mMaxWidth = inputWidth - 1;
-
-        const int appendixLow[4] = {-2, -1, 0, 1};
-        const int appendixHigh[4] = {2, 3, 0, 0};
-
-        const VF4 aVector = Set(dfx4, a);
-        VF4 srcXV = Set(dfx4, srcX);
-        VI4 kx1V = Set(dix4, kx1);
-        const VI4 appendixLowV = LoadU(dix4, appendixLow);
-        const VI4 appendixHighV = LoadU(dix4, appendixHigh);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight;
-          if (option == lanczos) {
-            yWeight = LanczosWindow(dy, float(kernelSize));
-          } else {
-            yWeight = Hann(float(j), float(kernelSize));
-          }
-          auto row = reinterpret_cast<const uint8_t *>(src8 +
-              clamp(yj, 0,
-                    inputHeight - 1) *
-                  srcStride);
-          VF4 yWeightV = Set(dfx4, yWeight);
-          VI4 xi = Add(kx1V, appendixLowV);
-          VF4 dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          VF4 sampleParameter = dx;
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixLowV);
-          }
-          VF4 weights = Mul(SampleOptionResult(dfx4, sampleParameter, option),
-                            yWeightV);
-          kWeightSum += ExtractLane(SumOfLanes(dfx4, weights), 0);
-          for (int i = 0; i < 4; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VU8x4 u81 = LoadU(du8x4,
-                              reinterpret_cast<const uint8_t *>(&row[sizeXPos]));
-            VF4 fr1 = ConvertTo(dfx4, PromoteTo(dix4, u81));
-            fr1 = Mul(fr1, Set(dfx4, ExtractLane(weights, i)));
-            color = Add(color, fr1);
-          }
-
-          xi = Add(kx1V, appendixHighV);
-          dx = Sub(srcXV, ConvertTo(dfx4, xi));
-          sampleParameter = dx;
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixLowV);
-          }
-          weights = Mul(SampleOptionResult(dfx4, sampleParameter, option), yWeightV);
-          if (option == hann) {
-            sampleParameter = ConvertTo(dfx4, appendixHighV);
-          }
-          for (int i = 0; i < 2; ++i) {
-            int sizeXPos = clamp(ExtractLane(xi, i), 0, mMaxWidth) * components;
-            VU8x4 u81 = LoadU(du8x4,
-                              reinterpret_cast<const uint8_t *>(&row[sizeXPos]));
-            VF4 fr1 = ConvertTo(dfx4, PromoteTo(dix4, u81));
-            float weight = ExtractLane(weights, i);
-            kWeightSum += weight;
-            fr1 = Mul(fr1, Set(dfx4, weight));
-            color = Add(color, fr1);
-          }
-        }
+    }
+    out[colorChannels] = static_cast<uint8_t>((alphaSum + count / 2) / count);
+  }
+}
 
-        if (kWeightSum == 0) {
-          color = ClampRound(dfx4, color, vfZeros, maxColorsV);
-          VU8x4 u8Color = DemoteTo(du8x4, ConvertTo(dux4, color));
-          StoreU(u8Color, du8x4,
-                 reinterpret_cast<uint8_t *>(&dst[x * components]));
-        } else {
-          color = ClampRound(dfx4, Div(color, Set(dfx4, kWeightSum)), vfZeros,
-                             maxColorsV);
-          VU8x4 u8Color = DemoteTo(du8x4, ConvertTo(dux4, color));
-          StoreU(u8Color, du8x4,
-                 reinterpret_cast<uint8_t *>(&dst[x * components]));
-        }
-      } else {
-        auto lanczosFA = float(3.0f);
-        int a = 3;
-        switch (option) {
-          case hann:a = 3;
-            lanczosFA = 3;
-            break;
-          default:break;
-        }
-        float rgb[components];
-        fill(rgb, rgb + components, 0.0f);
-
-        float kx1 = floor(srcX);
-        float ky1 = floor(srcY);
-
-        float weightSum(0.0f);
-
-        for (int j = -a + 1; j <= a; j++) {
-          int yj = (int) ky1 + j;
-          float dy = float(srcY) - (float(ky1) + (float) j);
-          float yWeight;
-          if (option == lanczos) {
-            yWeight = LanczosWindow(dy, float(lanczosFA));
-          } else {
-            yWeight = Hann(float(j), float(lanczosFA));
-          }
-          for (int i = -a + 1; i <= a; i++) {
-            int xi = (int) kx1 + i;
-            float dx = float(srcX) - (float(kx1) + (float) i);
-            float weight;
-            if (option == lanczos) {
-              weight = LanczosWindow(dx, float(lanczosFA)) * yWeight;
-            } else {
-              weight = Hann(float(i), float(lanczosFA)) * yWeight;
-            }
-            weightSum += weight;
-
-            auto row = reinterpret_cast<const uint8_t *>(src8 +
-                clamp(yj, 0,
-                      inputHeight - 1) *
-                    srcStride);
-
-            for (int c = 0; c < components; ++c) {
-              auto clrf = static_cast<float>(row[
-                  clamp(xi, 0, inputWidth - 1) * components + c]);
-              float clr = clrf * weight;
-              rgb[c] += clr;
-            }
-          }
+void BoxReduceRowF16(const uint8_t *src8, const int srcStride,
+                     const int inputWidth, const int inputHeight,
+                     uint16_t *dst, const int outputWidth,
+                     const int components, const int factorX, const int factorY,
+                     const int y, const XAlphaMode alphaMode, float *sums) {
+  const ScalableTag<float32_t> df;
+  const Rebind<float16_t, decltype(df)> df16;
+  const int lanes = static_cast<int>(Lanes(df));
+  const int top = y * factorY;
+  const int bottom = min(top + factorY, inputHeight);
+  const int rowLength = inputWidth * components;
+  const int colorChannels = TransferChannels(components);
+  // Straight alpha colours are summed premultiplied and divided back once reduced
+  const bool premultiply = alphaMode != alphaAsIs && colorChannels < components;
+  fill(sums, sums + rowLength, 0.f);
+
+  for (int sy = top; sy < bottom; ++sy) {
+    auto row = reinterpret_cast<const uint16_t *>(src8 + sy * srcStride);
+    auto row16 = reinterpret_cast<const float16_t *>(row);
+    if (premultiply) {
+      for (int x = 0; x < inputWidth; ++x) {
+        const uint16_t *pixel = row + x * components;
+        float *sum = sums + x * components;
+        const float alpha = static_cast<float>(castU16(pixel[colorChannels]));
+        for (int c = 0; c < colorChannels; ++c) {
+          sum[c] += static_cast<float>(castU16(pixel[c])) * alpha;
         }
+        sum[colorChannels] += alpha;
+      }
+      continue;
+    }
+    int i = 0;
+    for (; i + lanes <= rowLength; i += lanes) {
+      StoreU(Add(LoadU(df, sums + i), PromoteTo(df, LoadU(df16, row16 + i))), df, sums + i);
+    }
+    for (; i < rowLength; ++i) {
+      sums[i] += static_cast<float>(castU16(row[i]));
+    }
+  }
 
-        for (int c = 0; c < components; ++c) {
-          if (weightSum == 0) {
-            dst[x * components + c] = static_cast<uint8_t>(clamp(round(rgb[c]),
-                                                                 0.0f,
-                                                                 maxColors));
-          } else {
-            dst[x * components + c] = static_cast<uint8_t>(clamp(
-                round(rgb[c] / weightSum),
-                0.0f, maxColors));
-          }
-        }
+  // Reduced values are written in place, output pixel x never reads columns left of x
+  for (int x = 0; x < outputWidth; ++x) {
+    const int left = x * factorX;
+    const int right = min(left + factorX, inputWidth);
+    const float scale = 1.f / static_cast<float>((right - left) * (bottom - top));
+    float alphaSum = 0.f;
+    for (int c = components - 1; c >= 0; --c) {
+      float sum = 0.f;
+      for (int sx = left; sx < right; ++sx) {
+        sum += sums[sx * components + c];
       }
-    } else {
-      if (components == 4) {
-        auto row = reinterpret_cast<const uint8_t *>(src8 + y1 * srcStride);
-        reinterpret_cast<uint32_t *>(dst)[x] = reinterpret_cast<const uint32_t *>(row)[x1];
-      } else {
-        auto row = reinterpret_cast<const uint8_t *>(src8 + y1 * srcStride);
-        memcpy(&dst[x * components], &row[x1 * components],
-               sizeof(uint8_t) * components);
+      if (premultiply && c == colorChannels) {
+        alphaSum = sum;
+      } else if (premultiply && alphaMode == alphaStraight) {
+        sum = alphaSum > 0.f ? sum / alphaSum : 0.f;
+        sums[x * components + c] = sum;
+        continue;
       }
+      sums[x * components + c] = sum * scale;
     }
   }
+  StoreRow(sums, dst, outputWidth * components, 0.f);
 }
 
-void scaleImageU8HWY(const uint8_t *input,
-                     const int srcStride,
-                     int inputWidth,
-                     int inputHeight,
-                     uint8_t *output,
-                     const int dstStride,
-                     int outputWidth,
-                     int outputHeight,
-                     const int components,
-                     const int depth,
-                     const XSampler option) {
-  float xScale = static_cast<float>(inputWidth) / static_cast<float>(outputWidth);
-  float yScale = static_cast<float>(inputHeight) / static_cast<float>(outputHeight);
-
-  auto src8 = reinterpret_cast<const uint8_t *>(input);
+int HorizontalFilterLanesHWY() {
+  return static_cast<int>(std::clamp(Lanes(ScalableTag<float32_t>()), static_cast<size_t>(kMinPaddedLanes),
+                                     static_cast<size_t>(kMaxPaddedLanes)));
+}
 
-  float maxColors = std::powf(2.0f, static_cast<float>(depth)) - 1.0f;
+void boxDownscaleU8HWY(const uint8_t *input, const int srcStride,
+                       const int inputWidth, const int inputHeight,
+                       uint8_t *output, const int dstStride,
+                       const int factorX, const int factorY,
+                       const int components, const XAlphaMode alphaMode) {
+  const int outputWidth = (inputWidth + factorX - 1) / factorX;
+  const int outputHeight = (inputHeight + factorY - 1) / factorY;
+  const int threadCount = 6;
+  if (alphaMode != alphaAsIs && TransferChannels(components) < components) {
+    std::vector<std::vector<uint64_t>> sums(threadCount, std::vector<uint64_t>(inputWidth * components));
+    concurrency::parallel_for_with_thread_id(threadCount, outputHeight, [&](int threadId, int y) {
+      BoxReducePremultipliedRowU8(input, srcStride, inputWidth, inputHeight,
+                                  output + y * dstStride, outputWidth,
+                                  components, factorX, factorY, y, alphaMode, sums[threadId].data());
+    });
+    return;
+  }
+  std::vector<std::vector<uint32_t>> sums(threadCount, std::vector<uint32_t>(inputWidth * components));
+  concurrency::parallel_for_with_thread_id(threadCount, outputHeight, [&](int threadId, int y) {
+    BoxReduceRowU8(input, srcStride, inputWidth, inputHeight,
+                   output + y * dstStride, outputWidth,
+                   components, factorX, factorY, y, sums[threadId].data());
+  });
+}
 
-  concurrency::parallel_for(6, outputHeight, [&](int y) {
-    ScaleRowU8(src8, srcStride, inputWidth, inputHeight, output,
-               dstStride, outputWidth, components,
-               option,
-               xScale, yScale, maxColors, y);
+void boxDownscaleFloat16HWY(const uint16_t *input, const int srcStride,
+                            const int inputWidth, const int inputHeight,
+                            uint16_t *output, const int dstStride,
+                            const int factorX, const int factorY,
+                            const int components, const XAlphaMode alphaMode) {
+  const int outputWidth = (inputWidth + factorX - 1) / factorX;
+  const int outputHeight = (inputHeight + factorY - 1) / factorY;
+  const int threadCount = 6;
+  std::vector<std::vector<float>> sums(threadCount, std::vector<float>(inputWidth * components));
+  concurrency::parallel_for_with_thread_id(threadCount, outputHeight, [&](int threadId, int y) {
+    BoxReduceRowF16(reinterpret_cast<const uint8_t *>(input), srcStride, inputWidth, inputHeight,
+                    reinterpret_cast<uint16_t *>(reinterpret_cast<uint8_t *>(output) + y * dstStride),
+                    outputWidth, components, factorX, factorY, y, alphaMode, sums[threadId].data());
   });
 }
 }
@@ -850,6 +960,24 @@ HWY_AFTER_NAMESPACE();
 
 #if HWY_ONCE
 namespace coder {
+
+/**
+ * Plan given by the caller when it was made for this resize, otherwise a fresh one
+ */
+static std::shared_ptr<const ResizePlan> ResolveResizePlan(const ResizePlan *plan,
+                                                           int inputWidth, int inputHeight,
+                                                           int outputWidth, int outputHeight,
+                                                           int windowX, int windowY,
+                                                           int windowWidth, int windowHeight,
+                                                           XSampler option, bool fixedPoint) {
+  const ResizePlanKey key = {inputWidth, inputHeight, outputWidth, outputHeight,
+                             windowX, windowY, windowWidth, windowHeight, option, fixedPoint};
+  if (plan && plan->key == key) {
+    return std::shared_ptr<const ResizePlan>(std::shared_ptr<const ResizePlan>(), plan);
+  }
+  return BuildResizePlan(key);
+}
+
 HWY_EXPORT(scaleImageFloat16HWY);
 
 void scaleImageFloat16(const uint16_t *input,
@@ -859,10 +987,21 @@ void scaleImageFloat16(const uint16_t *input,
                        int dstStride,
                        int outputWidth, int outputHeight,
                        int components,
-                       XSampler option) {
-  HWY_DYNAMIC_DISPATCH(scaleImageFloat16HWY)(input, srcStride, inputWidth, inputHeight,
-                                             output, dstStride, outputWidth, outputHeight,
-                                             components, option);
+                       XSampler option,
+                       int windowX, int windowY,
+                       int windowWidth, int windowHeight,
+                       bool linearLight, XAlphaMode alphaMode,
+                       const ResizePlan *plan) {
+  if (windowWidth < 0) {
+    windowWidth = outputWidth - windowX;
+  }
+  if (windowHeight < 0) {
+    windowHeight = outputHeight - windowY;
+  }
+  const auto resolved = ResolveResizePlan(plan, inputWidth, inputHeight, outputWidth, outputHeight,
+                                          windowX, windowY, windowWidth, windowHeight, option, false);
+  HWY_DYNAMIC_DISPATCH(scaleImageFloat16HWY)(input, srcStride, output, dstStride,
+                                             components, linearLight, alphaMode, *resolved);
 }
 
 HWY_EXPORT(scaleImageU8HWY);
@@ -875,10 +1014,53 @@ void scaleImageU8(const uint8_t *input,
                   int outputWidth, int outputHeight,
                   int components,
                   int depth,
-                  XSampler option) {
-  HWY_DYNAMIC_DISPATCH(scaleImageU8HWY)(input, srcStride, inputWidth, inputHeight, output,
-                                        dstStride, outputWidth, outputHeight, components,
-                                        depth, option);
+                  XSampler option,
+                  int windowX, int windowY,
+                  int windowWidth, int windowHeight,
+                  bool linearLight, XAlphaMode alphaMode,
+                  const ResizePlan *plan) {
+  if (windowWidth < 0) {
+    windowWidth = outputWidth - windowX;
+  }
+  if (windowHeight < 0) {
+    windowHeight = outputHeight - windowY;
+  }
+  const auto resolved = ResolveResizePlan(plan, inputWidth, inputHeight, outputWidth, outputHeight,
+                                          windowX, windowY, windowWidth, windowHeight, option, depth == 8);
+  HWY_DYNAMIC_DISPATCH(scaleImageU8HWY)(input, srcStride, output, dstStride, components,
+                                        depth, linearLight, alphaMode, *resolved);
+}
+
+HWY_EXPORT(HorizontalFilterLanesHWY);
+
+int HorizontalFilterLanes() {
+  return HWY_DYNAMIC_DISPATCH(HorizontalFilterLanesHWY)();
+}
+
+HWY_EXPORT(boxDownscaleU8HWY);
+
+void boxDownscaleU8(const uint8_t *input,
+                    int srcStride,
+                    int inputWidth, int inputHeight,
+                    uint8_t *output,
+                    int dstStride,
+                    int factorX, int factorY,
+                    int components, XAlphaMode alphaMode) {
+  HWY_DYNAMIC_DISPATCH(boxDownscaleU8HWY)(input, srcStride, inputWidth, inputHeight,
+                                          output, dstStride, factorX, factorY, components, alphaMode);
+}
+
+HWY_EXPORT(boxDownscaleFloat16HWY);
+
+void boxDownscaleFloat16(const uint16_t *input,
+                         int srcStride,
+                         int inputWidth, int inputHeight,
+                         uint16_t *output,
+                         int dstStride,
+                         int factorX, int factorY,
+                         int components, XAlphaMode alphaMode) {
+  HWY_DYNAMIC_DISPATCH(boxDownscaleFloat16HWY)(input, srcStride, inputWidth, inputHeight,
+                                               output, dstStride, factorX, factorY, components, alphaMode);
 }
 }
 #endif
\ No newline at end of file
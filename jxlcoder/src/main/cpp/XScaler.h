@@ -41,10 +41,38 @@ enum XSampler {
   hermite = 7,
   bSpline = 8,
   hann = 9,
-  bicubic = 10
+  bicubic = 10,
+  area = 11
 };
 
+/**
+ * Treatment of the alpha channel of gray alpha and RGBA images while resampling
+ */
+enum XAlphaMode {
+  // Channels are filtered independently, the source is opaque or already premultiplied
+  alphaAsIs = 0,
+  // Straight alpha, colours are filtered premultiplied and divided back by alpha on store
+  alphaStraight = 1,
+  // Straight alpha source resampled into premultiplied output
+  alphaPremultiplyOutput = 2
+};
+
+/**
+ * Bit set on the sampler value passed from Java to request linear light resampling
+ */
+constexpr int kLinearLightSampling = 1 << 8;
+
 namespace coder {
+struct ResizePlan;
+
+/**
+ * Scales input to outputWidth x outputHeight. When a window is given only the pixels of the scaled image
+ * inside [windowX, windowX + windowWidth) x [windowY, windowY + windowHeight) are computed and written
+ * to output from its origin, a negative window size extends the window to the end of the scaled image.
+ * linearLight treats colour channels as sRGB encoded and filters them in linear light, alpha is left as is.
+ * alphaMode premultiplies straight alpha while filtering so transparent pixels don't bleed into the edges.
+ * plan holds precomputed weights and is used when it was built for the same sizes, window and sampler.
+ */
 void scaleImageFloat16(const uint16_t *input,
                        int srcStride,
                        int inputWidth,
@@ -54,7 +82,14 @@ void scaleImageFloat16(const uint16_t *input,
                        int outputWidth,
                        int outputHeight,
                        int components,
-                       XSampler option);
+                       XSampler option,
+                       int windowX = 0,
+                       int windowY = 0,
+                       int windowWidth = -1,
+                       int windowHeight = -1,
+                       bool linearLight = false,
+                       XAlphaMode alphaMode = alphaAsIs,
+                       const ResizePlan *plan = nullptr);
 
 void scaleImageU8(const uint8_t *input,
                   int srcStride,
@@ -66,7 +101,46 @@ void scaleImageU8(const uint8_t *input,
                   int outputHeight,
                   int components,
                   int depth,
-                  XSampler option);
+                  XSampler option,
+                  int windowX = 0,
+                  int windowY = 0,
+                  int windowWidth = -1,
+                  int windowHeight = -1,
+                  bool linearLight = false,
+                  XAlphaMode alphaMode = alphaAsIs,
+                  const ResizePlan *plan = nullptr);
+
+/**
+ * Widest vector, in 32 bit lanes, the horizontal filters of the running target use, 4 to 16
+ */
+int HorizontalFilterLanes();
+
+/**
+ * Averages factorX x factorY blocks of pixels, output is ceil(input / factor) in both dimensions
+ * and edge blocks average only the pixels that are left.
+ * alphaMode weights straight alpha colours by their alpha, see XAlphaMode.
+ */
+void boxDownscaleU8(const uint8_t *input,
+                    int srcStride,
+                    int inputWidth,
+                    int inputHeight,
+                    uint8_t *output,
+                    int dstStride,
+                    int factorX,
+                    int factorY,
+                    int components,
+                    XAlphaMode alphaMode = alphaAsIs);
+
+void boxDownscaleFloat16(const uint16_t *input,
+                         int srcStride,
+                         int inputWidth,
+                         int inputHeight,
+                         uint16_t *output,
+                         int dstStride,
+                         int factorX,
+                         int factorY,
+                         int components,
+                         XAlphaMode alphaMode = alphaAsIs);
 }
 
 #endif //JXLCODER_XSCALER_H
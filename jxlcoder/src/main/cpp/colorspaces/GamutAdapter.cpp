@@ -31,6 +31,8 @@
 #include <thread>
 #include "Eigen/Eigen"
 #include "concurrency.hpp"
+#include "TransformCache.h"
+#include "processing/TransferLut.h"
 
 using namespace std;
 
@@ -53,6 +55,19 @@ using hwy::float16_t;
 
 static const float sdrReferencePoint = 203.0f;
 
+// Integer inputs up to this many code values are linearised by table lookup
+static const int kMaxLinearTableSize = 4096;
+
+/**
+ * Transfer curves of integer pixels tabulated once: linear holds the EOTF with one segment
+ * per code value, encode the square spaced OETF on [0, 1].
+ * Empty tables mean the curve is evaluated per pixel.
+ */
+struct TransferTables {
+  TransferLut linear;
+  TransferLut encode;
+};
+
 template<class D>
 struct ChromaAdaptation {
   ChromaAdaptation(D d,
@@ -60,13 +75,15 @@ struct ChromaAdaptation {
                    CurveToneMapper curveToneMapper,
                    const float gamma,
                    const bool useChromaticAdaptation,
-                   const float maxColors) :
+                   const float maxColors,
+                   const TransferTables *tables = nullptr) :
       d(d),
       conversion(conversion),
       gamma(gamma),
       useChromaticAdaptation(useChromaticAdaptation),
       maxColors(maxColors),
-      scaleColors(1.f / maxColors) {
+      scaleColors(1.f / maxColors),
+      tables(tables) {
     const float lumaPrimaries[3] = {0.2627f, 0.6780f, 0.0593f};
     if (curveToneMapper == LOGARITHMIC) {
       mapper.reset(new LogarithmicToneMapper<Rebind<hwy::float32_t, decltype(d)>>(lumaPrimaries));
@@ -93,14 +110,64 @@ struct ChromaAdaptation {
 
     const auto zeros = Zero(df32);
 
+    if (tables && !tables->linear.table.empty()) {
+      // Integer samples index the table directly
+      const Rebind<int32_t, decltype(df32)> di32;
+      const auto maxIndex = Set(di32, static_cast<int32_t>(tables->linear.size));
+      const float *table = tables->linear.table.data();
+      pqR = GatherIndex(df32, table, Min(ConvertTo(di32, R), maxIndex));
+      pqG = GatherIndex(df32, table, Min(ConvertTo(di32, G), maxIndex));
+      pqB = GatherIndex(df32, table, Min(ConvertTo(di32, B), maxIndex));
+    } else {
+      if (std::is_same<TFromD<D>, uint8_t>::value ||
+          std::is_same<TFromD<D>, uint16_t>::value) {
+        const auto vScaleColors = Set(df32, scaleColors);
+        R = Mul(R, vScaleColors);
+        G = Mul(G, vScaleColors);
+        B = Mul(B, vScaleColors);
+      }
+      Linearize(function, R, G, B, pqR, pqG, pqB);
+    }
+
+    mapper->Execute(pqR, pqG, pqB);
+
+    if (conversion) {
+      convertColorProfile(df32, *conversion, pqR, pqG, pqB);
+      if (useChromaticAdaptation) {
+        const auto adopt = getBradfordAdaptation();
+        convertColorProfile(df32, adopt, pqR, pqG, pqB);
+      }
+    }
+
+    if (tables && !tables->encode.table.empty()) {
+      pqR = EncodeFromTable(df32, pqR);
+      pqG = EncodeFromTable(df32, pqG);
+      pqB = EncodeFromTable(df32, pqB);
+    } else {
+      Encode(gammaCorrection, pqR, pqG, pqB);
+    }
+
     if (std::is_same<TFromD<D>, uint8_t>::value ||
         std::is_same<TFromD<D>, uint16_t>::value) {
-      const auto vScaleColors = Set(df32, scaleColors);
-      R = Mul(R, vScaleColors);
-      G = Mul(G, vScaleColors);
-      B = Mul(B, vScaleColors);
+      const auto vColors = Set(df32, maxColors);
+      pqR = Clamp(Round(Mul(pqR, vColors)), zeros, vColors);
+      pqG = Clamp(Round(Mul(pqG, vColors)), zeros, vColors);
+      pqB = Clamp(Round(Mul(pqB, vColors)), zeros, vColors);
     }
 
+    R = pqR;
+    G = pqG;
+    B = pqB;
+  }
+
+  /**
+   * EOTF of samples in [0, 1]
+   */
+  template<typename T = Vec<Rebind<hwy::float32_t, D>>>
+  void Linearize(const GamutTransferFunction function, const T R, const T G, const T B,
+                 T &pqR, T &pqG, T &pqB) {
+    const Rebind<hwy::float32_t, D> df32;
+
     switch (function) {
       case PQ: {
         pqR = ToLinearPQ(df32, R, sdrReferencePoint);
@@ -182,16 +249,14 @@ struct ChromaAdaptation {
       }
         break;
     }
+  }
 
-    mapper->Execute(pqR, pqG, pqB);
-
-    if (conversion) {
-      convertColorProfile(df32, *conversion, pqR, pqG, pqB);
-      if (useChromaticAdaptation) {
-        const auto adopt = getBradfordAdaptation();
-        convertColorProfile(df32, adopt, pqR, pqG, pqB);
-      }
-    }
+  /**
+   * OETF of linear samples
+   */
+  template<typename T = Vec<Rebind<hwy::float32_t, D>>>
+  void Encode(const GammaCurve &gammaCorrection, T &pqR, T &pqG, T &pqB) {
+    const Rebind<hwy::float32_t, D> df32;
 
     if (gammaCorrection == DCIP3) {
       pqR = dciP3PQGammaCorrection(df32, pqR);
@@ -211,27 +276,30 @@ struct ChromaAdaptation {
       pqG = SRGBOetf(df32, pqG);
       pqB = SRGBOetf(df32, pqB);
     }
-
-    if (std::is_same<TFromD<D>, uint8_t>::value ||
-        std::is_same<TFromD<D>, uint16_t>::value) {
-      const auto vColors = Set(df32, maxColors);
-      pqR = Clamp(Round(Mul(pqR, vColors)), zeros, vColors);
-      pqG = Clamp(Round(Mul(pqG, vColors)), zeros, vColors);
-      pqB = Clamp(Round(Mul(pqB, vColors)), zeros, vColors);
-    }
-
-    R = pqR;
-    G = pqG;
-    B = pqB;
   }
 
  private:
+  template<class DF, typename T = Vec<DF>>
+  T EncodeFromTable(const DF df32, const T v) {
+    const Rebind<int32_t, DF> di32;
+    const TransferLut &encode = tables->encode;
+    const auto tableSize = Set(df32, static_cast<float>(encode.size));
+    const auto position = Mul(Sqrt(Min(Max(v, Zero(df32)), Set(df32, 1.f))), tableSize);
+    const auto base = Floor(position);
+    const auto index = ConvertTo(di32, base);
+    const float *table = encode.table.data();
+    const auto low = GatherIndex(df32, table, index);
+    const auto high = GatherIndex(df32, table + 1, index);
+    return MulAdd(Sub(high, low), Sub(position, base), low);
+  }
+
   const D d;
   const Eigen::Matrix3f *conversion;
   const float gamma;
   const bool useChromaticAdaptation;
   const float maxColors;
   const float scaleColors;
+  const TransferTables *tables;
 
   unique_ptr<ToneMapper<Rebind<hwy::float32_t, decltype(d)>>> mapper;
 };
@@ -244,7 +312,9 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
                  Eigen::Matrix3f *conversion,
                  const float gamma,
                  const bool useChromaticAdaptation,
-                 const float maxColors) {
+                 const float maxColors,
+                 const int components,
+                 const TransferTables *tables = nullptr) {
   const Rebind<TFromD<D>, Half<decltype(d)>> dHalf;
   const FixedTag<hwy::float32_t, 4> df32;
   const Rebind<hwy::float32_t, decltype(dHalf)> rebind32;
@@ -255,7 +325,7 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
 
   ChromaAdaptation<decltype(dHalf)> chromaAdaptation(dHalf, conversion, curveToneMapper,
                                                      gamma,
-                                                     useChromaticAdaptation, maxColors);
+                                                     useChromaticAdaptation, maxColors, tables);
 
   auto ptr16 = reinterpret_cast<TFromD<D> *>(data);
 
@@ -267,7 +337,11 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     VFull GURow;
     VFull BURow;
     VFull AURow;
-    LoadInterleaved4(d, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow, AURow);
+    if (components == 4) {
+      LoadInterleaved4(d, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(d, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow);
+    }
     VF32 rLow32 = PromoteLowerTo(rebind32, RURow);
     VF32 gLow32 = PromoteLowerTo(rebind32, GURow);
     VF32 bLow32 = PromoteLowerTo(rebind32, BURow);
@@ -286,12 +360,19 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     VHalf gHighNew = DemoteTo(dHalf, gHigh32);
     VHalf bHighNew = DemoteTo(dHalf, bHigh32);
 
-    StoreInterleaved4(Combine(d, rHighNew, rLowNew),
-                      Combine(d, gHighNew, gLowNew),
-                      Combine(d, bHighNew, bLowNew),
-                      AURow, d,
-                      reinterpret_cast<TFromD<D> *>(ptr16));
-    ptr16 += 4 * pixels;
+    if (components == 4) {
+      StoreInterleaved4(Combine(d, rHighNew, rLowNew),
+                        Combine(d, gHighNew, gLowNew),
+                        Combine(d, bHighNew, bLowNew),
+                        AURow, d,
+                        reinterpret_cast<TFromD<D> *>(ptr16));
+    } else {
+      StoreInterleaved3(Combine(d, rHighNew, rLowNew),
+                        Combine(d, gHighNew, gLowNew),
+                        Combine(d, bHighNew, bLowNew), d,
+                        reinterpret_cast<TFromD<D> *>(ptr16));
+    }
+    ptr16 += components * pixels;
   }
 
   const FixedTag<TFromD<D>, 1> dFixed1;
@@ -301,15 +382,18 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
 
   ChromaAdaptation<decltype(dFixed1)> chromaAdaptation1(dFixed1, conversion, curveToneMapper,
                                                         gamma,
-                                                        useChromaticAdaptation, maxColors);
+                                                        useChromaticAdaptation, maxColors, tables);
 
   for (; x < width; ++x) {
     V1 RURow;
     V1 GURow;
     V1 BURow;
     V1 AURow;
-    LoadInterleaved4(dFixed1, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow,
-                     AURow);
+    if (components == 4) {
+      LoadInterleaved4(dFixed1, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(dFixed1, reinterpret_cast<TFromD<D> *>(ptr16), RURow, GURow, BURow);
+    }
     VF1 rLow32 = PromoteTo(f1, RURow);
     VF1 gLow32 = PromoteTo(f1, GURow);
     VF1 bLow32 = PromoteTo(f1, BURow);
@@ -320,9 +404,19 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     V1 gLowNew = DemoteTo(dFixed1, gLow32);
     V1 bLowNew = DemoteTo(dFixed1, bLow32);
 
-    StoreInterleaved4(rLowNew, gLowNew, bLowNew, AURow, dFixed1,
-                      reinterpret_cast<TFromD<D> *>(ptr16));
-    ptr16 += 4;
+    if (components == 4) {
+      StoreInterleaved4(rLowNew,
+                        gLowNew,
+                        bLowNew,
+                        AURow, dFixed1,
+                        reinterpret_cast<TFromD<D> *>(ptr16));
+    } else {
+      StoreInterleaved3(rLowNew,
+                        gLowNew,
+                        bLowNew, dFixed1,
+                        reinterpret_cast<TFromD<D> *>(ptr16));
+    }
+    ptr16 += components;
   }
 }
 
@@ -334,7 +428,8 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
                  Eigen::Matrix3f *conversion,
                  const float gamma,
                  const bool useChromaticAdaptation,
-                 const float maxColors) {
+                 const float maxColors,
+                 const int components) {
   const Rebind<TFromD<D>, Half<decltype(d)>> dHalf;
   const FixedTag<hwy::float32_t, 4> df32;
   const Rebind<hwy::float32_t, decltype(dHalf)> rebind32;
@@ -359,8 +454,11 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     VStore GURow;
     VStore BURow;
     VStore AURow;
-    LoadInterleaved4(dStore, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow,
-                     AURow);
+    if (components == 4) {
+      LoadInterleaved4(dStore, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(dStore, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow);
+    }
 
     VFull rFull = BitCast(d, RURow);
     VFull gFull = BitCast(d, GURow);
@@ -384,12 +482,19 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     VHalf gHighNew = DemoteTo(dHalf, gHigh32);
     VHalf bHighNew = DemoteTo(dHalf, bHigh32);
 
-    StoreInterleaved4(BitCast(dStore, Combine(d, rHighNew, rLowNew)),
-                      BitCast(dStore, Combine(d, gHighNew, gLowNew)),
-                      BitCast(dStore, Combine(d, bHighNew, bLowNew)),
-                      AURow, dStore,
-                      reinterpret_cast<uint16_t *>(ptr16));
-    ptr16 += 4 * pixels;
+    if (components == 4) {
+      StoreInterleaved4(BitCast(dStore, Combine(d, rHighNew, rLowNew)),
+                        BitCast(dStore, Combine(d, gHighNew, gLowNew)),
+                        BitCast(dStore, Combine(d, bHighNew, bLowNew)),
+                        AURow, dStore,
+                        reinterpret_cast<uint16_t *>(ptr16));
+    } else {
+      StoreInterleaved3(BitCast(dStore, Combine(d, rHighNew, rLowNew)),
+                        BitCast(dStore, Combine(d, gHighNew, gLowNew)),
+                        BitCast(dStore, Combine(d, bHighNew, bLowNew)), dStore,
+                        reinterpret_cast<uint16_t *>(ptr16));
+    }
+    ptr16 += components * pixels;
   }
 
   const FixedTag<TFromD<D>, 1> dFixed1;
@@ -408,8 +513,11 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     VU1 GURow;
     VU1 BURow;
     VU1 AURow;
-    LoadInterleaved4(dUFixed1, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow,
-                     AURow);
+    if (components == 4) {
+      LoadInterleaved4(dUFixed1, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(dUFixed1, reinterpret_cast<uint16_t *>(ptr16), RURow, GURow, BURow);
+    }
     VF1 rLow32 = PromoteTo(f1, BitCast(dFixed1, RURow));
     VF1 gLow32 = PromoteTo(f1, BitCast(dFixed1, GURow));
     VF1 bLow32 = PromoteTo(f1, BitCast(dFixed1, BURow));
@@ -420,22 +528,143 @@ ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
     V1 gLowNew = DemoteTo(dFixed1, gLow32);
     V1 bLowNew = DemoteTo(dFixed1, bLow32);
 
-    StoreInterleaved4(BitCast(dUFixed1, rLowNew),
-                      BitCast(dUFixed1, gLowNew),
-                      BitCast(dUFixed1, bLowNew),
-                      AURow, dUFixed1,
-                      reinterpret_cast<uint16_t *>(ptr16));
-    ptr16 += 4;
+    if (components == 4) {
+      StoreInterleaved4(BitCast(dUFixed1, rLowNew),
+                        BitCast(dUFixed1, gLowNew),
+                        BitCast(dUFixed1, bLowNew),
+                        AURow, dUFixed1,
+                        reinterpret_cast<uint16_t *>(ptr16));
+    } else {
+      StoreInterleaved3(BitCast(dUFixed1, rLowNew),
+                        BitCast(dUFixed1, gLowNew),
+                        BitCast(dUFixed1, bLowNew), dUFixed1,
+                        reinterpret_cast<uint16_t *>(ptr16));
+    }
+    ptr16 += components;
   }
 }
 
+template<class D, HWY_IF_F32_D(D)>
+void
+ProcessDoubleRow(D d, TFromD<D> *HWY_RESTRICT data, const int width,
+                 const GammaCurve gammaCorrection, const GamutTransferFunction function,
+                 CurveToneMapper curveToneMapper,
+                 Eigen::Matrix3f *conversion,
+                 const float gamma,
+                 const bool useChromaticAdaptation,
+                 const float maxColors,
+                 const int components) {
+  using VF32 = Vec<decltype(d)>;
+
+  ChromaAdaptation<decltype(d)> chromaAdaptation(d, conversion, curveToneMapper,
+                                                 gamma,
+                                                 useChromaticAdaptation, maxColors);
+
+  auto ptr32 = reinterpret_cast<TFromD<D> *>(data);
+
+  const int pixels = static_cast<int>(Lanes(d));
+
+  int x = 0;
+  for (; x + pixels < width; x += pixels) {
+    VF32 R;
+    VF32 G;
+    VF32 B;
+    VF32 A;
+    if (components == 4) {
+      LoadInterleaved4(d, ptr32, R, G, B, A);
+    } else {
+      LoadInterleaved3(d, ptr32, R, G, B);
+    }
+
+    chromaAdaptation.TransferRow(gammaCorrection, function, R, G, B);
+
+    if (components == 4) {
+      StoreInterleaved4(R, G, B, A, d, ptr32);
+    } else {
+      StoreInterleaved3(R, G, B, d, ptr32);
+    }
+    ptr32 += components * pixels;
+  }
+
+  const FixedTag<TFromD<D>, 1> dFixed1;
+  using VF1 = Vec<decltype(dFixed1)>;
+
+  ChromaAdaptation<decltype(dFixed1)> chromaAdaptation1(dFixed1, conversion, curveToneMapper,
+                                                        gamma,
+                                                        useChromaticAdaptation, maxColors);
+
+  for (; x < width; ++x) {
+    VF1 R;
+    VF1 G;
+    VF1 B;
+    VF1 A;
+    if (components == 4) {
+      LoadInterleaved4(dFixed1, ptr32, R, G, B, A);
+    } else {
+      LoadInterleaved3(dFixed1, ptr32, R, G, B);
+    }
+
+    chromaAdaptation1.TransferRow(gammaCorrection, function, R, G, B);
+
+    if (components == 4) {
+      StoreInterleaved4(R, G, B, A, dFixed1, ptr32);
+    } else {
+      StoreInterleaved3(R, G, B, dFixed1, ptr32);
+    }
+    ptr32 += components;
+  }
+}
+
+/**
+ * Tables for integer pixels with maxColors + 1 code values, built on first use and kept
+ * in the transform cache, so their number stays bounded however many profile gammas come by
+ */
+static std::shared_ptr<const TransferTables> GetTransferTables(const GamutTransferFunction function,
+                                                               const GammaCurve gammaCorrection,
+                                                               const float gamma, const float maxColors) {
+  const float key[4] = {static_cast<float>(function), static_cast<float>(gammaCorrection), gamma, maxColors};
+  const int codeValues = static_cast<int>(maxColors) + 1;
+  const bool linearTable = codeValues <= kMaxLinearTableSize;
+  const bool encodeTable = gammaCorrection != NONE;
+  const size_t footprint = ((linearTable ? codeValues + 1 : 0) + (encodeTable ? kTransferLutSize + 2 : 0))
+      * sizeof(float);
+
+  auto handle = TransformCache::instance().get(
+      reinterpret_cast<const unsigned char *>(key), sizeof(key), kTransferTablesPixelType, 0,
+      [&]() -> std::shared_ptr<void> {
+        auto tables = std::make_shared<TransferTables>();
+        const FixedTag<float32_t, 4> df;
+        // Float curves run on [0, 1] without scaling, rounding or clamping
+        ChromaAdaptation<decltype(df)> curves(df, nullptr, TONE_SKIP, gamma, false, maxColors);
+        if (linearTable) {
+          tables->linear = BuildTransferLut([&](float v) {
+            const auto x = Set(df, v);
+            Vec<decltype(df)> r, g, b;
+            curves.Linearize(function, x, x, x, r, g, b);
+            return GetLane(r);
+          }, codeValues - 1);
+        }
+        if (encodeTable) {
+          tables->encode = BuildTransferLut([&](float v) {
+            auto r = Set(df, v), g = r, b = r;
+            curves.Encode(gammaCorrection, r, g, b);
+            return GetLane(r);
+          }, kTransferLutSize, true);
+        }
+        return tables;
+      }, footprint);
+  return std::static_pointer_cast<const TransferTables>(handle);
+}
+
 void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxColors,
                   const GammaCurve gammaCorrection,
                   const GamutTransferFunction function,
                   CurveToneMapper curveToneMapper,
                   Eigen::Matrix3f *conversion,
                   const float gamma,
-                  const bool useChromaticAdaptation) {
+                  const bool useChromaticAdaptation,
+                  const int components,
+                  const TransferTables *tables) {
   const FixedTag<float32_t, 4> df32;
   const FixedTag<uint8_t, 16> d;
   const FixedTag<uint16_t, 8> du16;
@@ -463,7 +692,7 @@ void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxCo
 
   ChromaAdaptation<decltype(du8x4)> chromaAdaptation(du8x4, conversion, curveToneMapper,
                                                      gamma,
-                                                     useChromaticAdaptation, maxColors);
+                                                     useChromaticAdaptation, maxColors, tables);
 
   int x = 0;
   for (; x + pixels < width; x += pixels) {
@@ -471,7 +700,11 @@ void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxCo
     VU8 GURow;
     VU8 BURow;
     VU8 AURow;
-    LoadInterleaved4(d, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow, AURow);
+    if (components == 4) {
+      LoadInterleaved4(d, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(d, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow);
+    }
     auto lowR16 = PromoteLowerTo(du16, RURow);
     auto lowG16 = PromoteLowerTo(du16, GURow);
     auto lowB16 = PromoteLowerTo(du16, BURow);
@@ -548,14 +781,24 @@ void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxCo
     auto gU8x16 = Combine(d, DemoteTo(du8x8, highG), DemoteTo(du8x8, lowG));
     auto bU8x16 = Combine(d, DemoteTo(du8x8, highB), DemoteTo(du8x8, lowB));
 
-    StoreInterleaved4(rU8x16, gU8x16, bU8x16, AURow, d,
-                      reinterpret_cast<uint8_t *>(ptr16));
-    ptr16 += 4 * 16;
+    if (components == 4) {
+      StoreInterleaved4(rU8x16,
+                        gU8x16,
+                        bU8x16,
+                        AURow, d,
+                        reinterpret_cast<uint8_t *>(ptr16));
+    } else {
+      StoreInterleaved3(rU8x16,
+                        gU8x16,
+                        bU8x16, d,
+                        reinterpret_cast<uint8_t *>(ptr16));
+    }
+    ptr16 += components * 16;
   }
 
   ChromaAdaptation<decltype(du8x1)> chromaAdaptation1Pixel(du8x1, conversion, curveToneMapper,
                                                            gamma,
-                                                           useChromaticAdaptation, maxColors);
+                                                           useChromaticAdaptation, maxColors, tables);
 
   const VF32x1 recProcColors1 = Set(df32x1, 1.f / static_cast<float>(maxColors));
 
@@ -564,7 +807,11 @@ void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxCo
     VU8x1 GURow;
     VU8x1 BURow;
     VU8x1 AURow;
-    LoadInterleaved4(du8x1, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow, AURow);
+    if (components == 4) {
+      LoadInterleaved4(du8x1, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow, AURow);
+    } else {
+      LoadInterleaved3(du8x1, reinterpret_cast<uint8_t *>(ptr16), RURow, GURow, BURow);
+    }
 
     VF32x1 r = PromoteTo(df32x1, RURow);
     VF32x1 g = PromoteTo(df32x1, GURow);
@@ -580,10 +827,20 @@ void ProcessUSRow(uint8_t *HWY_RESTRICT data, const int width, const float maxCo
     GURow = DemoteTo(du8x1, g);
     BURow = DemoteTo(du8x1, b);
 
-    StoreInterleaved4(RURow, GURow, BURow, AURow, du8x1,
-                      reinterpret_cast<uint8_t *>(ptr16));
+    if (components == 4) {
+      StoreInterleaved4(RURow,
+                        GURow,
+                        BURow,
+                        AURow, du8x1,
+                        reinterpret_cast<uint8_t *>(ptr16));
+    } else {
+      StoreInterleaved3(RURow,
+                        GURow,
+                        BURow, du8x1,
+                        reinterpret_cast<uint8_t *>(ptr16));
+    }
 
-    ptr16 += 4;
+    ptr16 += components;
   }
 }
 
@@ -594,17 +851,19 @@ void ProcessGamutHighwayU16(uint16_t *data, const int width, const int height,
                             CurveToneMapper curveToneMapper,
                             Eigen::Matrix3f *conversion,
                             const float gamma,
-                            const bool useChromaticAdaptation) {
+                            const bool useChromaticAdaptation,
+                            const int components) {
   const int threadCount = std::clamp(
       std::min(static_cast<int>(std::thread::hardware_concurrency()),
                height * width / (256 * 256)), 1, 12);
+  const auto tables = GetTransferTables(function, gammaCorrection, gamma, maxColors);
   concurrency::parallel_for(threadCount, height, [&](int y) {
     auto ptr16 = reinterpret_cast<uint16_t *>(reinterpret_cast<uint8_t *>(data) +
         y * stride);
     const FixedTag<uint16_t, 8> df;
     ProcessDoubleRow(df, reinterpret_cast<uint16_t *>(ptr16), width,
                      gammaCorrection, function, curveToneMapper,
-                     conversion, gamma, useChromaticAdaptation, maxColors);
+                     conversion, gamma, useChromaticAdaptation, maxColors, components, tables.get());
   });
 }
 
@@ -616,7 +875,8 @@ ProcessGamutHighwayF16(hwy::float16_t *data, const int width, const int height,
                        CurveToneMapper curveToneMapper,
                        Eigen::Matrix3f *conversion,
                        const float gamma,
-                       const bool useChromaticAdaptation) {
+                       const bool useChromaticAdaptation,
+                       const int components) {
   const int threadCount = std::clamp(
       std::min(static_cast<int>(std::thread::hardware_concurrency()),
                height * width / (256 * 256)), 1, 12);
@@ -625,7 +885,29 @@ ProcessGamutHighwayF16(hwy::float16_t *data, const int width, const int height,
     const FixedTag<hwy::float16_t, 8> df;
     ProcessDoubleRow(df, reinterpret_cast<hwy::float16_t *>(ptr16), width,
                      gammaCorrection, function, curveToneMapper,
-                     conversion, gamma, useChromaticAdaptation, maxColors);
+                     conversion, gamma, useChromaticAdaptation, maxColors, components);
+  });
+}
+
+void
+ProcessGamutHighwayF32(hwy::float32_t *data, const int width, const int height,
+                       const int stride, const float maxColors,
+                       const GammaCurve gammaCorrection,
+                       const GamutTransferFunction function,
+                       CurveToneMapper curveToneMapper,
+                       Eigen::Matrix3f *conversion,
+                       const float gamma,
+                       const bool useChromaticAdaptation,
+                       const int components) {
+  const int threadCount = std::clamp(
+      std::min(static_cast<int>(std::thread::hardware_concurrency()),
+               height * width / (256 * 256)), 1, 12);
+  concurrency::parallel_for(threadCount, height, [&](int y) {
+    auto ptr32 = reinterpret_cast<hwy::float32_t *>(reinterpret_cast<uint8_t *>(data) + y * stride);
+    const FixedTag<hwy::float32_t, 4> df;
+    ProcessDoubleRow(df, ptr32, width,
+                     gammaCorrection, function, curveToneMapper,
+                     conversion, gamma, useChromaticAdaptation, maxColors, components);
   });
 }
 
@@ -636,17 +918,19 @@ void ProcessGamutHighwayU8(uint8_t *data, const int width, const int height,
                            const CurveToneMapper curveToneMapper,
                            Eigen::Matrix3f *conversion,
                            const float gamma,
-                           const bool useChromaticAdaptation) {
+                           const bool useChromaticAdaptation,
+                       const int components) {
   const int threadCount = std::clamp(
       std::min(static_cast<int>(std::thread::hardware_concurrency()),
                height * width / (256 * 256)), 1, 12);
+  const auto tables = GetTransferTables(function, gammaCorrection, gamma, maxColors);
   concurrency::parallel_for(threadCount, height, [&](int y) {
     auto ptr16 = reinterpret_cast<uint8_t *>(reinterpret_cast<uint8_t *>(data) + y * stride);
     ProcessUSRow(reinterpret_cast<uint8_t *>(ptr16),
                  width,
                  (float) maxColors, gammaCorrection, function,
                  curveToneMapper, conversion, gamma,
-                 useChromaticAdaptation);
+                 useChromaticAdaptation, components, tables.get());
   });
 }
 }
@@ -658,6 +942,7 @@ namespace coder {
 HWY_EXPORT(ProcessGamutHighwayU8);
 HWY_EXPORT(ProcessGamutHighwayF16);
 HWY_EXPORT(ProcessGamutHighwayU16);
+HWY_EXPORT(ProcessGamutHighwayF32);
 
 template<class T>
 HWY_DLLEXPORT void
@@ -669,25 +954,32 @@ ProcessCPUDispatcher(T *data, const int width, const int height,
                      const CurveToneMapper curveToneMapper,
                      Eigen::Matrix3f *conversion,
                      const float gamma,
-                     const bool useChromaticAdaptation) {
+                     const bool useChromaticAdaptation,
+                     const int components) {
   if (std::is_same<T, uint8_t>::value) {
     HWY_DYNAMIC_DISPATCH(ProcessGamutHighwayU8)(reinterpret_cast<uint8_t *>(data),
                                                 width, height, stride,
                                                 maxColors, gammaCorrection,
                                                 function, curveToneMapper, conversion, gamma,
-                                                useChromaticAdaptation);
+                                                useChromaticAdaptation, components);
   } else if (std::is_same<T, uint16_t>::value) {
     HWY_DYNAMIC_DISPATCH(ProcessGamutHighwayU16)(reinterpret_cast<uint16_t *>(data),
                                                  width, height, stride,
                                                  maxColors, gammaCorrection,
                                                  function, curveToneMapper, conversion, gamma,
-                                                 useChromaticAdaptation);
+                                                 useChromaticAdaptation, components);
+  } else if (std::is_same<T, hwy::float32_t>::value) {
+    HWY_DYNAMIC_DISPATCH(ProcessGamutHighwayF32)(reinterpret_cast<hwy::float32_t *>(data),
+                                                 width, height, stride,
+                                                 maxColors, gammaCorrection,
+                                                 function, curveToneMapper, conversion, gamma,
+                                                 useChromaticAdaptation, components);
   } else if (std::is_same<T, hwy::float16_t>::value) {
     HWY_DYNAMIC_DISPATCH(ProcessGamutHighwayF16)(reinterpret_cast<hwy::float16_t *>(data),
                                                  width, height, stride,
                                                  maxColors, gammaCorrection,
                                                  function, curveToneMapper, conversion, gamma,
-                                                 useChromaticAdaptation);
+                                                 useChromaticAdaptation, components);
   }
 }
 
@@ -700,7 +992,8 @@ ProcessCPUDispatcher(uint8_t *data, const int width, const int height,
                      const CurveToneMapper curveToneMapper,
                      Eigen::Matrix3f *conversion,
                      const float gamma,
-                     const bool useChromaticAdaptation);
+                     const bool useChromaticAdaptation,
+                     const int components);
 
 template void
 ProcessCPUDispatcher(uint16_t *data, const int width, const int height,
@@ -711,7 +1004,8 @@ ProcessCPUDispatcher(uint16_t *data, const int width, const int height,
                      const CurveToneMapper curveToneMapper,
                      Eigen::Matrix3f *conversion,
                      const float gamma,
-                     const bool useChromaticAdaptation);
+                     const bool useChromaticAdaptation,
+                     const int components);
 
 template void
 ProcessCPUDispatcher(hwy::float16_t *data, const int width, const int height,
@@ -722,7 +1016,20 @@ ProcessCPUDispatcher(hwy::float16_t *data, const int width, const int height,
                      const CurveToneMapper curveToneMapper,
                      Eigen::Matrix3f *conversion,
                      const float gamma,
-                     const bool useChromaticAdaptation);
+                     const bool useChromaticAdaptation,
+                     const int components);
+
+template void
+ProcessCPUDispatcher(hwy::float32_t *data, const int width, const int height,
+                     const int stride,
+                     const float maxColors,
+                     const GammaCurve gammaCorrection,
+                     const GamutTransferFunction function,
+                     const CurveToneMapper curveToneMapper,
+                     Eigen::Matrix3f *conversion,
+                     const float gamma,
+                     const bool useChromaticAdaptation,
+                     const int components);
 }
 
 #endif
@@ -58,8 +58,12 @@ namespace coder {
                          const CurveToneMapper curveToneMapper,
                          Eigen::Matrix3f *conversion,
                          const float gamma,
-                         const bool useChromaticAdaptation);
+                         const bool useChromaticAdaptation,
+                         const int components);
 
+    /**
+     * Transfers RGBA rows, or RGB rows when components is 3, alpha is left untouched.
+     */
     template<class T>
     class GamutAdapter {
     public:
@@ -68,7 +72,8 @@ namespace coder {
                      GamutTransferFunction function, CurveToneMapper toneMapper,
                      Eigen::Matrix3f *conversion,
                      const float gamma,
-                     const bool useChromaticAdaptation)
+                     const bool useChromaticAdaptation,
+                     const int components = 4)
                 : function(function),
                   gammaCorrection(gammaCorrection),
                   bitDepth(bitDepth),
@@ -79,7 +84,8 @@ namespace coder {
                   toneMapper(toneMapper),
                   mColorProfileConversion(conversion),
                   gamma(gamma),
-                  useChromaticAdaptation(useChromaticAdaptation) {
+                  useChromaticAdaptation(useChromaticAdaptation),
+                  components(components) {
         }
 
         void transfer() {
@@ -88,7 +94,8 @@ namespace coder {
                                         this->stride, maxColors, this->gammaCorrection,
                                         this->function, this->toneMapper,
                                         this->mColorProfileConversion,
-                                        this->gamma, this->useChromaticAdaptation);
+                                        this->gamma, this->useChromaticAdaptation,
+                                        this->components);
         }
 
     private:
@@ -103,6 +110,7 @@ namespace coder {
         Eigen::Matrix3f *mColorProfileConversion;
         const float gamma;
         bool useChromaticAdaptation;
+        const int components;
     protected:
     };
 }
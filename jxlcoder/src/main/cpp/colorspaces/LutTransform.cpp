@@ -0,0 +1,236 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "LutTransform.h"
+#include <algorithm>
+#include <cmath>
+#include "icc/lcms2.h"
+#include "concurrency.hpp"
+
+#if defined(__clang__)
+#pragma clang fp contract(fast) exceptions(ignore) reassociate(on)
+#endif
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "colorspaces/LutTransform.cpp"
+
+#include "hwy/foreach_target.h"
+#include "hwy/highway.h"
+#include "algo/math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+using hwy::float32_t;
+
+/**
+ * Tetrahedral interpolation of one pixel, r, g, b are in [0, 255]. The cube cell is split along
+ * its main diagonal and the tetrahedron holding the point is picked by ordering the fractions
+ */
+static inline void Lut3DPixel(const float *table, const int gridSize, const float r, const float g, const float b,
+                              float *out) {
+  const int strideR = gridSize * gridSize * 3;
+  const int strideG = gridSize * 3;
+  const float toGrid = static_cast<float>(gridSize - 1) / 255.f;
+  const float x = r * toGrid, y = g * toGrid, z = b * toGrid;
+  const int xi = std::min(static_cast<int>(x), gridSize - 2);
+  const int yi = std::min(static_cast<int>(y), gridSize - 2);
+  const int zi = std::min(static_cast<int>(z), gridSize - 2);
+  const float fx = x - static_cast<float>(xi), fy = y - static_cast<float>(yi), fz = z - static_cast<float>(zi);
+  // First step goes along the axis with the largest fraction, the last one along the smallest
+  const int offsetA = (fx >= fy && fx >= fz) ? strideR : (fy >= fz ? strideG : 3);
+  const int offsetMin = (fz <= fx && fz <= fy) ? 3 : (fy <= fx ? strideG : strideR);
+  const int offsetAll = strideR + strideG + 3;
+  const int offsetB = offsetAll - offsetMin;
+  const float w1 = std::max(fx, std::max(fy, fz));
+  const float w3 = std::min(fx, std::min(fy, fz));
+  const float w2 = fx + fy + fz - w1 - w3;
+  const float *cell = table + xi * strideR + yi * strideG + zi * 3;
+  for (int c = 0; c < 3; ++c) {
+    const float c000 = cell[c];
+    const float cA = cell[offsetA + c];
+    const float cB = cell[offsetB + c];
+    const float c111 = cell[offsetAll + c];
+    out[c] = c000 + w1 * (cA - c000) + w2 * (cB - cA) + w3 * (c111 - cB);
+  }
+}
+
+template<class D, typename V = Vec<D>>
+HWY_INLINE void Lut3DVector(const D df, const float *table, const int gridSize, V &r, V &g, V &b) {
+  const RebindToSigned<decltype(df)> di;
+  const int strideR = gridSize * gridSize * 3;
+  const int strideG = gridSize * 3;
+  const auto toGrid = Set(df, static_cast<float>(gridSize - 1) / 255.f);
+  const auto maxCell = Set(di, gridSize - 2);
+  const auto strideRV = Set(di, strideR);
+  const auto strideGV = Set(di, strideG);
+  const auto strideBV = Set(di, 3);
+  const auto offsetAll = Set(di, strideR + strideG + 3);
+
+  const auto x = Mul(r, toGrid), y = Mul(g, toGrid), z = Mul(b, toGrid);
+  const auto xi = Min(ConvertTo(di, x), maxCell);
+  const auto yi = Min(ConvertTo(di, y), maxCell);
+  const auto zi = Min(ConvertTo(di, z), maxCell);
+  const auto fx = Sub(x, ConvertTo(df, xi));
+  const auto fy = Sub(y, ConvertTo(df, yi));
+  const auto fz = Sub(z, ConvertTo(df, zi));
+
+  const auto xGeY = RebindMask(di, Ge(fx, fy));
+  const auto xGeZ = RebindMask(di, Ge(fx, fz));
+  const auto yGeZ = RebindMask(di, Ge(fy, fz));
+  const auto offsetA = IfThenElse(And(xGeY, xGeZ), strideRV, IfThenElse(yGeZ, strideGV, strideBV));
+  const auto offsetMin = IfThenElse(And(xGeZ, yGeZ), strideBV, IfThenElse(xGeY, strideGV, strideRV));
+  const auto offsetB = Sub(offsetAll, offsetMin);
+  const auto w1 = Max(fx, Max(fy, fz));
+  const auto w3 = Min(fx, Min(fy, fz));
+  const auto w2 = Sub(Sub(Add(fx, Add(fy, fz)), w1), w3);
+
+  const auto cell = Add(Add(Mul(xi, strideRV), Mul(yi, strideGV)), Mul(zi, strideBV));
+  V result[3];
+  for (int c = 0; c < 3; ++c) {
+    const auto index = Add(cell, Set(di, c));
+    const auto c000 = GatherIndex(df, table, index);
+    const auto cA = GatherIndex(df, table, Add(index, offsetA));
+    const auto cB = GatherIndex(df, table, Add(index, offsetB));
+    const auto c111 = GatherIndex(df, table, Add(index, offsetAll));
+    result[c] = MulAdd(w3, Sub(c111, cB), MulAdd(w2, Sub(cB, cA), MulAdd(w1, Sub(cA, c000), c000)));
+  }
+  r = result[0];
+  g = result[1];
+  b = result[2];
+}
+
+template<class D, typename V = Vec<D>>
+HWY_INLINE V EncodeOutput(const D df, const float *transfer, V v) {
+  const RebindToSigned<decltype(df)> di;
+  const auto position = Min(Max(Mul(v, Set(df, static_cast<float>(kTransferLutSize))), Zero(df)),
+                            Set(df, static_cast<float>(kTransferLutSize)));
+  const auto base = Floor(position);
+  const auto index = ConvertTo(di, base);
+  const auto low = GatherIndex(df, transfer, index);
+  const auto high = GatherIndex(df, transfer + 1, index);
+  return MulAdd(Sub(high, low), Sub(position, base), low);
+}
+
+void ApplyLut3DRowU8(uint8_t *row, const int width, const int components, const Lut3D &lut) {
+  const ScalableTag<float32_t> df;
+  const RebindToSigned<decltype(df)> di;
+  const Rebind<uint8_t, decltype(di)> du8;
+  const int lanes = static_cast<int>(Lanes(df));
+  const float *table = lut.table.data();
+  const int gridSize = lut.gridSize;
+  const float *transfer = lut.outputTransfer ? lut.outputTransfer->table.data() : nullptr;
+  const auto zeros = Zero(df);
+  const auto maxColors = Set(df, 255.f);
+  int x = 0;
+  for (; x + lanes <= width; x += lanes) {
+    uint8_t *pixels = row + x * components;
+    Vec<decltype(du8)> r8, g8, b8, a8;
+    if (components == 4) {
+      LoadInterleaved4(du8, pixels, r8, g8, b8, a8);
+    } else {
+      LoadInterleaved3(du8, pixels, r8, g8, b8);
+    }
+    auto r = ConvertTo(df, PromoteTo(di, r8));
+    auto g = ConvertTo(df, PromoteTo(di, g8));
+    auto b = ConvertTo(df, PromoteTo(di, b8));
+    Lut3DVector(df, table, gridSize, r, g, b);
+    if (transfer) {
+      r = EncodeOutput(df, transfer, r);
+      g = EncodeOutput(df, transfer, g);
+      b = EncodeOutput(df, transfer, b);
+    }
+    r = Mul(r, maxColors);
+    g = Mul(g, maxColors);
+    b = Mul(b, maxColors);
+    r8 = DemoteTo(du8, ConvertTo(di, ClampRound(df, r, zeros, maxColors)));
+    g8 = DemoteTo(du8, ConvertTo(di, ClampRound(df, g, zeros, maxColors)));
+    b8 = DemoteTo(du8, ConvertTo(di, ClampRound(df, b, zeros, maxColors)));
+    if (components == 4) {
+      StoreInterleaved4(r8, g8, b8, a8, du8, pixels);
+    } else {
+      StoreInterleaved3(r8, g8, b8, du8, pixels);
+    }
+  }
+  for (; x < width; ++x) {
+    uint8_t *pixel = row + x * components;
+    float out[3];
+    Lut3DPixel(table, gridSize, pixel[0], pixel[1], pixel[2], out);
+    for (int c = 0; c < 3; ++c) {
+      const float value = lut.outputTransfer ? lut.outputTransfer->apply(out[c]) : out[c];
+      pixel[c] = static_cast<uint8_t>(std::clamp(std::round(value * 255.f), 0.f, 255.f));
+    }
+  }
+}
+
+void ApplyLut3DU8HWY(uint8_t *data, const int stride, const int width, const int height,
+                     const int components, const Lut3D &lut) {
+  concurrency::parallel_for(6, height, [&](int y) {
+    ApplyLut3DRowU8(data + y * stride, width, components, lut);
+  });
+}
+
+}
+
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace coder {
+HWY_EXPORT(ApplyLut3DU8HWY);
+
+std::shared_ptr<Lut3D> BakeLut3D(void *transform, const int gridSize, const TransferLut *outputTransfer) {
+  const int points = gridSize * gridSize * gridSize;
+  std::vector<float> lattice(points * 3);
+  const float step = 1.f / static_cast<float>(gridSize - 1);
+  float *point = lattice.data();
+  for (int r = 0; r < gridSize; ++r) {
+    for (int g = 0; g < gridSize; ++g) {
+      for (int b = 0; b < gridSize; ++b) {
+        point[0] = static_cast<float>(r) * step;
+        point[1] = static_cast<float>(g) * step;
+        point[2] = static_cast<float>(b) * step;
+        point += 3;
+      }
+    }
+  }
+  auto lut = std::make_shared<Lut3D>();
+  lut->gridSize = gridSize;
+  lut->outputTransfer = outputTransfer;
+  lut->table.resize(points * 3);
+  // Float transforms are unbounded, out of gamut points stay unclipped and only results are clamped
+  cmsDoTransform(reinterpret_cast<cmsHTRANSFORM>(transform), lattice.data(), lut->table.data(), points);
+  return lut;
+}
+
+void ApplyLut3DU8(uint8_t *data, int stride, int width, int height, int components, const Lut3D &lut) {
+  HWY_DYNAMIC_DISPATCH(ApplyLut3DU8HWY)(data, stride, width, height, components, lut);
+}
+}
+#endif
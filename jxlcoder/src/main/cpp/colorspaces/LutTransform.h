@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "processing/TransferLut.h"
+
+namespace coder {
+
+constexpr int kLut3DGridSize = 33;
+
+/**
+ * RGB to RGB transform sampled on a gridSize^3 lattice, red major with blue changing fastest,
+ * each point holds three unclipped output values with 1.0 at full scale.
+ * When outputTransfer is set the lattice holds linear values and interpolated results are encoded
+ * with it, so cells crossing black or the gamut edge don't bend the steep part of the curve.
+ */
+struct Lut3D {
+  int gridSize = 0;
+  std::vector<float> table;
+  const TransferLut *outputTransfer = nullptr;
+};
+
+/**
+ * Samples transform, an lcms handle converting TYPE_RGB_FLT into TYPE_RGB_FLT, on the lattice
+ */
+std::shared_ptr<Lut3D> BakeLut3D(void *transform, int gridSize, const TransferLut *outputTransfer = nullptr);
+
+/**
+ * Applies lut to 8 bit RGB or RGBA pixels in place with tetrahedral interpolation,
+ * alpha is left as is
+ */
+void ApplyLut3DU8(uint8_t *data, int stride, int width, int height, int components, const Lut3D &lut);
+}
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "MatrixTrcProfile.h"
+#include <cmath>
+#include <memory>
+#include "icc/lcms2.h"
+#include "hwy/highway.h"
+#include "algo/math-inl.h"
+#include "eotf-inl.h"
+
+namespace coder {
+
+// Curves are compared on this many points. Linear light of a match, encoded again by the candidate,
+// lands within half an 8 bit step of where it started, which holds near black as well
+static constexpr int kCurveSamples = 256;
+static constexpr float kCurveTolerance = 0.5f / 255.f;
+
+template<class Encode>
+static bool CurveMatches(const cmsToneCurve *curve, Encode candidateInverse) {
+  for (int i = 0; i <= kCurveSamples; ++i) {
+    const float v = static_cast<float>(i) / static_cast<float>(kCurveSamples);
+    if (std::abs(candidateInverse(cmsEvalToneCurveFloat(curve, v)) - v) > kCurveTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool ReadColorants(cmsHPROFILE profile, Eigen::Matrix3f &colorants) {
+  const cmsTagSignature tags[3] = {cmsSigRedColorantTag, cmsSigGreenColorantTag, cmsSigBlueColorantTag};
+  for (int c = 0; c < 3; ++c) {
+    auto xyz = reinterpret_cast<const cmsCIEXYZ *>(cmsReadTag(profile, tags[c]));
+    if (!xyz) {
+      return false;
+    }
+    colorants(0, c) = static_cast<float>(xyz->X);
+    colorants(1, c) = static_cast<float>(xyz->Y);
+    colorants(2, c) = static_cast<float>(xyz->Z);
+  }
+  return true;
+}
+
+/**
+ * sRGB colorants as lcms writes them, so the matrix lands where the lcms transform would
+ */
+static const Eigen::Matrix3f &SRGBColorants() {
+  static const Eigen::Matrix3f colorants = []() {
+    Eigen::Matrix3f matrix = Eigen::Matrix3f::Identity();
+    cmsHPROFILE srgb = cmsCreate_sRGBProfile();
+    if (srgb) {
+      ReadColorants(srgb, matrix);
+      cmsCloseProfile(srgb);
+    }
+    return matrix;
+  }();
+  return colorants;
+}
+
+MatrixTrcProfile AnalyseMatrixTrcProfile(const unsigned char *profile, size_t profileSize) {
+  MatrixTrcProfile result;
+  cmsHPROFILE handle = cmsOpenProfileFromMem(profile, profileSize);
+  if (!handle) {
+    return result;
+  }
+  std::shared_ptr<void> ptrHandle(handle, [](void *profile) {
+    cmsCloseProfile(reinterpret_cast<cmsHPROFILE>(profile));
+  });
+  // lcms prefers A2B tables over the matrix when both are present
+  if (cmsGetColorSpace(handle) != cmsSigRgbData || !cmsIsMatrixShaper(handle)
+      || cmsIsCLUT(handle, INTENT_PERCEPTUAL, LCMS_USED_AS_INPUT)) {
+    return result;
+  }
+
+  Eigen::Matrix3f colorants;
+  if (!ReadColorants(handle, colorants)) {
+    return result;
+  }
+
+  const cmsTagSignature trcTags[3] = {cmsSigRedTRCTag, cmsSigGreenTRCTag, cmsSigBlueTRCTag};
+  const cmsToneCurve *curves[3];
+  for (int c = 0; c < 3; ++c) {
+    curves[c] = reinterpret_cast<const cmsToneCurve *>(cmsReadTag(handle, trcTags[c]));
+    if (!curves[c]) {
+      return result;
+    }
+  }
+  cmsToneCurve *reversed = cmsReverseToneCurve(curves[0]);
+  if (!reversed) {
+    return result;
+  }
+  std::shared_ptr<cmsToneCurve> ptrReversed(reversed, [](cmsToneCurve *curve) {
+    cmsFreeToneCurve(curve);
+  });
+  for (int c = 1; c < 3; ++c) {
+    if (!CurveMatches(curves[c], [&](float v) { return cmsEvalToneCurveFloat(reversed, v); })) {
+      return result;
+    }
+  }
+
+  const float gamma = static_cast<float>(cmsEstimateGamma(curves[0], 0.01));
+  if (CurveMatches(curves[0], [](float v) { return HWY_NAMESPACE::SRGBOetf(v); })) {
+    result.function = EOTF_SRGB;
+  } else if (CurveMatches(curves[0], [](float v) { return HWY_NAMESPACE::Rec709Oetf(v); })) {
+    result.function = EOTF_BT709;
+  } else if (gamma > 0.f && CurveMatches(curves[0], [&](float v) { return std::pow(v, 1.f / gamma); })) {
+    result.function = gamma == 1.f ? SKIP : EOTF_GAMMA;
+    result.gamma = gamma;
+  } else {
+    return result;
+  }
+
+  // Colorants of both profiles are adapted to the D50 PCS, so no separate white point adaptation is needed
+  result.toSRGB = SRGBColorants().inverse() * colorants;
+  result.supported = true;
+  return result;
+}
+}
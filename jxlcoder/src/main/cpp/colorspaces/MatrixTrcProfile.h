@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "Eigen/Eigen"
+#include "GamutAdapter.h"
+
+namespace coder {
+
+/**
+ * RGB ICC profile made of colorants and per channel tone curves, reduced to what GamutAdapter runs:
+ * one EOTF for all channels and the matrix from linear source RGB into linear sRGB
+ */
+struct MatrixTrcProfile {
+  // False when the profile needs lcms, fields below are meaningful only when set
+  bool supported = false;
+  GamutTransferFunction function = SKIP;
+  float gamma = 1.f;
+  Eigen::Matrix3f toSRGB = Eigen::Matrix3f::Identity();
+};
+
+/**
+ * Reads colorants and TRC curves of an ICC profile. Gray, LUT based and profiles whose curves differ
+ * between channels or don't match sRGB, BT.709 or a pure gamma within half an 8 bit step of the
+ * encoded value come back unsupported.
+ */
+MatrixTrcProfile AnalyseMatrixTrcProfile(const unsigned char *profile, size_t profileSize);
+}
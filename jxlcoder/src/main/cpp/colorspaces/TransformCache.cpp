@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "TransformCache.h"
+#include <cstring>
+
+namespace coder {
+
+static constexpr size_t kTransformCacheBytes = 4 * 1024 * 1024;
+
+static uint64_t HashProfile(const unsigned char *data, size_t size) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+TransformCache &TransformCache::instance() {
+  static TransformCache cache;
+  return cache;
+}
+
+TransformCache::Handle TransformCache::get(const unsigned char *profile, size_t profileSize,
+                                           uint32_t pixelType, uint32_t intent, const Factory &factory,
+                                           size_t footprint) {
+  const uint64_t hash = HashProfile(profile, profileSize);
+  // Hash only narrows the search, profile bytes are compared so a collision can't pick a wrong transform
+  auto matches = [&](const Entry &entry) {
+    return entry.hash == hash && entry.pixelType == pixelType && entry.intent == intent
+        && entry.profile.size() == profileSize
+        && std::memcmp(entry.profile.data(), profile, profileSize) == 0;
+  };
+  {
+    std::lock_guard guard(mutex);
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (matches(*it)) {
+        entries.splice(entries.begin(), entries, it);
+        return it->transform;
+      }
+    }
+  }
+
+  // Built outside the lock, concurrent misses on one key may build twice and the later one is dropped
+  Handle transform = factory();
+  if (!transform) {
+    return transform;
+  }
+
+  std::lock_guard guard(mutex);
+  for (const auto &entry: entries) {
+    if (matches(entry)) {
+      return entry.transform;
+    }
+  }
+  Entry entry = {hash, pixelType, intent,
+                 std::vector<unsigned char>(profile, profile + profileSize),
+                 transform, profileSize + footprint};
+  usedBytes += entry.footprint;
+  entries.push_front(std::move(entry));
+  trim();
+  return transform;
+}
+
+void TransformCache::trim() {
+  // The newest entry is always kept, even when it alone exceeds the cap
+  while (usedBytes > kTransformCacheBytes && entries.size() > 1) {
+    usedBytes -= entries.back().footprint;
+    entries.pop_back();
+  }
+}
+}
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace coder {
+
+// lcms does not report the size of an optimised pipeline, an 8 bit RGB transform with
+// its prelinearisation tables and 33 point CLUT takes about this much
+constexpr size_t kTransformFootprint = 256 * 1024;
+
+// Keys of entries that aren't lcms transforms, lcms pixel formats always have channels
+constexpr uint32_t kLut3DPixelType = 0;
+constexpr uint32_t kMatrixTrcPixelType = 1;
+constexpr uint32_t kTransferTablesPixelType = 2;
+
+/**
+ * Process wide LRU of ready colour transforms, keyed by the source ICC profile bytes,
+ * pixel format and rendering intent. Images sharing a profile reuse the transform instead of
+ * parsing the profile and optimising a new pipeline each time.
+ * Handles are shared, an evicted transform lives until its last user releases it.
+ */
+class TransformCache {
+ public:
+  using Handle = std::shared_ptr<void>;
+  using Factory = std::function<Handle()>;
+
+  static TransformCache &instance();
+
+  /**
+   * Returns the cached transform or builds it with factory, failed builds are not cached.
+   * footprint is the memory a built entry is charged besides the profile bytes
+   */
+  Handle get(const unsigned char *profile, size_t profileSize,
+             uint32_t pixelType, uint32_t intent, const Factory &factory,
+             size_t footprint = kTransformFootprint);
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    uint32_t pixelType;
+    uint32_t intent;
+    std::vector<unsigned char> profile;
+    Handle transform;
+    size_t footprint;
+  };
+
+  void trim();
+
+  std::mutex mutex;
+  std::list<Entry> entries;
+  size_t usedBytes = 0;
+};
+}
@@ -32,12 +32,39 @@
 #include <android/log.h>
 #include <thread>
 #include "concurrency.hpp"
+#include "TransformCache.h"
+#include "LutTransform.h"
+#include "MatrixTrcProfile.h"
 
 using namespace std;
 
-void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, int stride, int width, int height,
-                                 const unsigned char *colorSpace, size_t colorSpaceSize,
-                                 bool image16Bits) {
+#define TYPE_GRAYA_HALF_FLT (FLOAT_SH(1)|COLORSPACE_SH(PT_GRAY)|EXTRA_SH(1)|CHANNELS_SH(1)|BYTES_SH(2))
+
+static cmsUInt32Number cmsPixelType(int components, bool image16Bits, bool image32Floats) {
+  if (image32Floats) {
+    switch (components) {
+      case 1: return TYPE_GRAY_FLT;
+      case 2: return TYPE_GRAYA_FLT;
+      case 3: return TYPE_RGB_FLT;
+      default: return TYPE_RGBA_FLT;
+    }
+  }
+  switch (components) {
+    case 1: return image16Bits ? TYPE_GRAY_HALF_FLT : TYPE_GRAY_8;
+    case 2: return image16Bits ? TYPE_GRAYA_HALF_FLT : TYPE_GRAYA_8;
+    case 3: return image16Bits ? TYPE_RGB_HALF_FLT : TYPE_RGB_8;
+    default: return image16Bits ? TYPE_RGBA_HALF_FLT : TYPE_RGBA_8;
+  }
+}
+
+/**
+ * Builds the transform from the given profile into sRGB, the handle keeps the lcms context alive
+ * for as long as the transform is used. linearOutput targets sRGB primaries with a linear curve.
+ */
+static std::shared_ptr<void> createSrgbTransform(const unsigned char *colorSpace, size_t colorSpaceSize,
+                                                 int components,
+                                                 cmsUInt32Number inputType, cmsUInt32Number outputType,
+                                                 cmsUInt32Number flags, bool linearOutput = false) {
   cmsContext context = cmsCreateContext(nullptr, nullptr);
   std::shared_ptr<void> contextPtr(context, [](void *profile) {
     cmsDeleteContext(reinterpret_cast<cmsContext>(profile));
@@ -46,47 +73,124 @@ void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, int stride, int w
   if (!srcProfile) {
     // JUST RETURN without signalling error, better proceed with invalid photo than crash
     __android_log_print(ANDROID_LOG_ERROR, "JXLCoder", "ColorProfile Allocation Failed");
-    return;
+    return nullptr;
   }
   std::shared_ptr<void> ptrSrcProfile(srcProfile, [](void *profile) {
     cmsCloseProfile(reinterpret_cast<cmsHPROFILE>(profile));
   });
-  cmsHPROFILE dstProfile = cmsCreate_sRGBProfileTHR(
-      reinterpret_cast<cmsContext>(contextPtr.get()));
+  bool grayProfile = cmsGetColorSpace(srcProfile) == cmsSigGrayData;
+  if (grayProfile != (components < 3)) {
+    __android_log_print(ANDROID_LOG_ERROR, "JXLCoder", "ColorProfile does not match pixels layout");
+    return nullptr;
+  }
+  cmsHPROFILE dstProfile;
+  if (grayProfile) {
+    // Gray stays gray, only the curve is replaced with the sRGB one
+    cmsFloat64Number srgbParameters[5] = {2.4, 1. / 1.055, 0.055 / 1.055, 1. / 12.92, 0.04045};
+    cmsToneCurve *srgbCurve = cmsBuildParametricToneCurve(reinterpret_cast<cmsContext>(contextPtr.get()),
+                                                          4, srgbParameters);
+    if (!srgbCurve) {
+      return nullptr;
+    }
+    cmsCIExyY d65 = {0.3127, 0.3290, 1.0};
+    dstProfile = cmsCreateGrayProfileTHR(reinterpret_cast<cmsContext>(contextPtr.get()), &d65, srgbCurve);
+    cmsFreeToneCurve(srgbCurve);
+  } else if (linearOutput) {
+    cmsToneCurve *linearCurve = cmsBuildGamma(reinterpret_cast<cmsContext>(contextPtr.get()), 1.0);
+    if (!linearCurve) {
+      return nullptr;
+    }
+    cmsCIExyY d65 = {0.3127, 0.3290, 1.0};
+    cmsCIExyYTRIPLE rec709 = {{0.6400, 0.3300, 1.0}, {0.3000, 0.6000, 1.0}, {0.1500, 0.0600, 1.0}};
+    cmsToneCurve *curves[3] = {linearCurve, linearCurve, linearCurve};
+    dstProfile = cmsCreateRGBProfileTHR(reinterpret_cast<cmsContext>(contextPtr.get()), &d65, &rec709, curves);
+    cmsFreeToneCurve(linearCurve);
+  } else {
+    dstProfile = cmsCreate_sRGBProfileTHR(
+        reinterpret_cast<cmsContext>(contextPtr.get()));
+  }
   std::shared_ptr<void> ptrDstProfile(dstProfile, [](void *profile) {
     cmsCloseProfile(reinterpret_cast<cmsHPROFILE>(profile));
   });
   cmsHTRANSFORM transform = cmsCreateTransform(ptrSrcProfile.get(),
-                                               image16Bits ? TYPE_RGBA_HALF_FLT : TYPE_RGBA_8,
+                                               inputType,
                                                ptrDstProfile.get(),
-                                               image16Bits ? TYPE_RGBA_HALF_FLT : TYPE_RGBA_8,
+                                               outputType,
                                                INTENT_PERCEPTUAL,
-                                               cmsFLAGS_BLACKPOINTCOMPENSATION |
-                                                   cmsFLAGS_NOWHITEONWHITEFIXUP |
-                                                   cmsFLAGS_COPY_ALPHA);
+                                               flags);
   if (!transform) {
     // JUST RETURN without signalling error, better proceed with invalid photo than crash
     __android_log_print(ANDROID_LOG_ERROR, "AVIFCoder", "ColorProfile Creation has hailed");
-    return;
+    return nullptr;
   }
-  std::shared_ptr<void> ptrTransform(transform, [](void *transform) {
+  return std::shared_ptr<void>(transform, [contextPtr](void *transform) {
     cmsDeleteTransform(reinterpret_cast<cmsHTRANSFORM>(transform));
   });
+}
+
+void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, int stride, int width, int height,
+                                 const unsigned char *colorSpace, size_t colorSpaceSize,
+                                 bool image16Bits, int components,
+                                 bool image32Floats) {
+  const cmsUInt32Number flags = cmsFLAGS_BLACKPOINTCOMPENSATION | cmsFLAGS_NOWHITEONWHITEFIXUP;
+  if (!image16Bits && !image32Floats && components >= 3) {
+    // Analysis is cached whatever its outcome, so profiles that need lcms are parsed only once
+    std::shared_ptr<void> analysis = coder::TransformCache::instance().get(
+        colorSpace, colorSpaceSize, coder::kMatrixTrcPixelType, INTENT_PERCEPTUAL, [&]() -> std::shared_ptr<void> {
+          return std::make_shared<coder::MatrixTrcProfile>(
+              coder::AnalyseMatrixTrcProfile(colorSpace, colorSpaceSize));
+        }, sizeof(coder::MatrixTrcProfile));
+    auto matrixTrc = std::static_pointer_cast<coder::MatrixTrcProfile>(analysis);
+    if (matrixTrc && matrixTrc->supported) {
+      if (matrixTrc->function == EOTF_SRGB && matrixTrc->toSRGB.isIdentity(1e-4f)) {
+        // Tagged sRGB, pixels are already what the conversion would produce
+        return;
+      }
+      coder::GamutAdapter<uint8_t> adapter(vector.data(), stride, width, height, 8,
+                                           sRGB, matrixTrc->function, TONE_SKIP,
+                                           &matrixTrc->toSRGB, matrixTrc->gamma, false, components);
+      adapter.transfer();
+      return;
+    }
 
-  std::vector<uint8_t> iccARGB;
-  iccARGB.resize(stride * height);
+    // 8 bit RGB goes through the transform baked into a 3D LUT, lcms evaluates only the lattice.
+    // The lattice is linear and the sRGB curve is applied after interpolation
+    std::shared_ptr<void> lut = coder::TransformCache::instance().get(
+        colorSpace, colorSpaceSize, coder::kLut3DPixelType, INTENT_PERCEPTUAL, [&]() -> std::shared_ptr<void> {
+          auto transform = createSrgbTransform(colorSpace, colorSpaceSize, components,
+                                               TYPE_RGB_FLT, TYPE_RGB_FLT, flags, true);
+          if (!transform) {
+            return nullptr;
+          }
+          return coder::BakeLut3D(transform.get(), coder::kLut3DGridSize, &coder::LinearToSRGBLut());
+        }, coder::kLut3DGridSize * coder::kLut3DGridSize * coder::kLut3DGridSize * 3 * sizeof(float));
+    if (lut) {
+      coder::ApplyLut3DU8(vector.data(), stride, width, height, components,
+                          *std::static_pointer_cast<const coder::Lut3D>(lut));
+      return;
+    }
+  }
 
-  auto mSrcInput = vector.data();
-  auto mDstARGB = iccARGB.data();
+  const cmsUInt32Number pixelType = cmsPixelType(components, image16Bits, image32Floats);
+  std::shared_ptr<void> ptrTransform = coder::TransformCache::instance().get(
+      colorSpace, colorSpaceSize, pixelType, INTENT_PERCEPTUAL, [&]() {
+        return createSrgbTransform(colorSpace, colorSpaceSize, components,
+                                   pixelType, pixelType, flags | cmsFLAGS_COPY_ALPHA);
+      });
+  if (!ptrTransform) {
+    return;
+  }
+
+  // Source and destination formats are the same and lcms unpacks each pixel before packing it,
+  // so rows are converted in place without a second frame buffer
+  auto mPixels = vector.data();
 
   concurrency::parallel_for(6, height, [&](int y) {
     cmsDoTransformLineStride(
         reinterpret_cast<void *>(ptrTransform.get()),
-        reinterpret_cast<const void *>(mSrcInput + stride * y),
-        reinterpret_cast<void *>(mDstARGB + stride * y),
+        reinterpret_cast<const void *>(mPixels + stride * y),
+        reinterpret_cast<void *>(mPixels + stride * y),
         width, 1,
         stride, stride, 0, 0);
   });
-
-  vector = iccARGB;
 }
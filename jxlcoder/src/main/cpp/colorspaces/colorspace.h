@@ -31,8 +31,14 @@
 
 #include <vector>
 
+/**
+ * Converts pixels in the given ICC profile into sRGB, components is 1 or 2 for gray profiles
+ * which stay gray with the sRGB transfer curve, 3 or 4 for RGB profiles.
+ * image32Floats marks float samples, image16Bits half float ones.
+ */
 void convertUseDefinedColorSpace(std::vector<uint8_t> &vector, int stride, int width, int height,
                                  const unsigned char *colorSpace, size_t colorSpaceSize,
-                                 bool image16Bits);
+                                 bool image16Bits, int components = 4,
+                                 bool image32Floats = false);
 
 #endif //JXLCODER_COLORSPACE_H
\ No newline at end of file
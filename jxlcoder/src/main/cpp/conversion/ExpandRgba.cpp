@@ -0,0 +1,211 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 05/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ExpandRgba.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "conversion/ExpandRgba.cpp"
+
+#include "hwy/foreach_target.h"  // IWYU pragma: keep
+
+#include "hwy/highway.h"
+#include "hwy/base.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace coder::HWY_NAMESPACE {
+
+using namespace hwy::HWY_NAMESPACE;
+
+template<class D, typename V = VFromD<D>, typename T = TFromD<D>>
+void
+ExpandRgbaROW(D d, const T *JXL_RESTRICT src, T *JXL_RESTRICT dst,
+              const uint32_t width, const uint32_t components, const T opaque) {
+  if (components == 4) {
+    memcpy(dst, src, width * 4 * sizeof(T));
+    return;
+  }
+  uint32_t x = 0;
+  auto srcPixels = reinterpret_cast<const T *>(src);
+  auto dstPixels = reinterpret_cast<T *>(dst);
+  const uint32_t pixels = Lanes(d);
+  const V alpha = Set(d, opaque);
+  for (; x + pixels < width; x += pixels) {
+    V pixels1;
+    V pixels2;
+    V pixels3;
+    if (components == 1) {
+      pixels1 = LoadU(d, srcPixels);
+      StoreInterleaved4(pixels1, pixels1, pixels1, alpha, d, dstPixels);
+    } else if (components == 2) {
+      LoadInterleaved2(d, srcPixels, pixels1, pixels2);
+      StoreInterleaved4(pixels1, pixels1, pixels1, pixels2, d, dstPixels);
+    } else {
+      LoadInterleaved3(d, srcPixels, pixels1, pixels2, pixels3);
+      StoreInterleaved4(pixels1, pixels2, pixels3, alpha, d, dstPixels);
+    }
+
+    srcPixels += components * pixels;
+    dstPixels += 4 * pixels;
+  }
+
+  for (; x < width; ++x) {
+    if (components == 1) {
+      dstPixels[0] = srcPixels[0];
+      dstPixels[1] = srcPixels[0];
+      dstPixels[2] = srcPixels[0];
+      dstPixels[3] = opaque;
+    } else if (components == 2) {
+      dstPixels[0] = srcPixels[0];
+      dstPixels[1] = srcPixels[0];
+      dstPixels[2] = srcPixels[0];
+      dstPixels[3] = srcPixels[1];
+    } else {
+      dstPixels[0] = srcPixels[0];
+      dstPixels[1] = srcPixels[1];
+      dstPixels[2] = srcPixels[2];
+      dstPixels[3] = opaque;
+    }
+
+    srcPixels += components;
+    dstPixels += 4;
+  }
+}
+
+template<class D, typename T = TFromD<D>>
+void ExpandToRGBAHWY(D d,
+                     const T *JXL_RESTRICT src,
+                     const uint32_t srcStride,
+                     const uint32_t components,
+                     T *JXL_RESTRICT dst,
+                     const uint32_t dstStride,
+                     const uint32_t width,
+                     const uint32_t height,
+                     const T opaque) {
+  auto srcData = reinterpret_cast<const uint8_t *>(src);
+  auto dstData = reinterpret_cast<uint8_t *>(dst);
+
+  for (uint32_t y = 0; y < height; ++y) {
+    ExpandRgbaROW(d, reinterpret_cast<const T *>(srcData + srcStride * y),
+                  reinterpret_cast<T *>(dstData + dstStride * y), width, components, opaque);
+  }
+}
+
+void ExpandToRGBAHWYU8(const uint8_t *JXL_RESTRICT src,
+                       const uint32_t srcStride,
+                       const uint32_t components,
+                       uint8_t *JXL_RESTRICT dst,
+                       const uint32_t dstStride,
+                       const uint32_t width,
+                       const uint32_t height,
+                       const uint8_t opaque) {
+  const ScalableTag<uint8_t> t;
+  ExpandToRGBAHWY(t, src, srcStride, components, dst, dstStride, width, height, opaque);
+}
+
+void ExpandToRGBAHWYU16(const uint16_t *JXL_RESTRICT src,
+                        const uint32_t srcStride,
+                        const uint32_t components,
+                        uint16_t *JXL_RESTRICT dst,
+                        const uint32_t dstStride,
+                        const uint32_t width,
+                        const uint32_t height,
+                        const uint16_t opaque) {
+  const ScalableTag<uint16_t> t;
+  ExpandToRGBAHWY(t, src, srcStride, components, dst, dstStride, width, height, opaque);
+}
+
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+
+namespace coder {
+HWY_EXPORT(ExpandToRGBAHWYU8);
+HWY_EXPORT(ExpandToRGBAHWYU16);
+
+template<class T>
+HWY_DLLEXPORT void ExpandToRGBA(const T *JXL_RESTRICT src,
+                                const uint32_t srcStride,
+                                const uint32_t components,
+                                T *JXL_RESTRICT dst,
+                                const uint32_t dstStride,
+                                const uint32_t width,
+                                const uint32_t height) {
+  if (std::is_same<T, uint8_t>::value) {
+    HWY_DYNAMIC_DISPATCH(ExpandToRGBAHWYU8)(reinterpret_cast<const uint8_t *>(src),
+                                            srcStride, components,
+                                            reinterpret_cast<uint8_t *>(dst),
+                                            dstStride,
+                                            width, height, 255);
+  } else if (std::is_same<T, hwy::float16_t>::value) {
+    // 0x3C00 is 1.0 in half float
+    HWY_DYNAMIC_DISPATCH(ExpandToRGBAHWYU16)(reinterpret_cast<const uint16_t *>(src),
+                                             srcStride, components,
+                                             reinterpret_cast<uint16_t *>(dst),
+                                             dstStride,
+                                             width, height, 0x3C00);
+  } else if (std::is_same<T, uint16_t>::value) {
+    HWY_DYNAMIC_DISPATCH(ExpandToRGBAHWYU16)(reinterpret_cast<const uint16_t *>(src),
+                                             srcStride, components,
+                                             reinterpret_cast<uint16_t *>(dst),
+                                             dstStride,
+                                             width, height, 65535);
+  }
+}
+
+template void ExpandToRGBA(const uint8_t *JXL_RESTRICT src,
+                           const uint32_t srcStride,
+                           const uint32_t components,
+                           uint8_t *JXL_RESTRICT dst,
+                           const uint32_t dstStride,
+                           const uint32_t width,
+                           const uint32_t height);
+
+template void ExpandToRGBA(const uint16_t *JXL_RESTRICT src,
+                           const uint32_t srcStride,
+                           const uint32_t components,
+                           uint16_t *JXL_RESTRICT dst,
+                           const uint32_t dstStride,
+                           const uint32_t width,
+                           const uint32_t height);
+
+template void ExpandToRGBA(const hwy::float16_t *JXL_RESTRICT src,
+                           const uint32_t srcStride,
+                           const uint32_t components,
+                           hwy::float16_t *JXL_RESTRICT dst,
+                           const uint32_t dstStride,
+                           const uint32_t width,
+                           const uint32_t height);
+
+}
+
+#endif
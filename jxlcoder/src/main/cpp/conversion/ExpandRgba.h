@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 05/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef JXLCODER_EXPANDRGBA_H
+#define JXLCODER_EXPANDRGBA_H
+
+#include <cstdint>
+#include "ConversionUtils.h"
+
+namespace coder {
+/**
+ * Expands gray, gray + alpha or RGB rows into RGBA, gray is replicated into all colour channels
+ * and missing alpha is filled as opaque. RGBA rows are copied as is.
+ */
+template<class T>
+void ExpandToRGBA(const T *JXL_RESTRICT src,
+                  const uint32_t srcStride,
+                  const uint32_t components,
+                  T *JXL_RESTRICT dst,
+                  const uint32_t dstStride,
+                  const uint32_t width,
+                  const uint32_t height);
+}
+
+#endif //JXLCODER_EXPANDRGBA_H
@@ -54,13 +54,13 @@ using hwy::HWY_NAMESPACE::Rebind;
 using hwy::HWY_NAMESPACE::Store;
 using hwy::HWY_NAMESPACE::BitCast;
 using hwy::HWY_NAMESPACE::StoreInterleaved4;
+using hwy::HWY_NAMESPACE::LoadU;
+using hwy::HWY_NAMESPACE::StoreU;
 
 void RGBAF32ToF16RowHWY(const float *JXL_RESTRICT src, uint16_t *JXL_RESTRICT dst, const uint32_t width) {
   const FixedTag<float, 4> df32;
-  const FixedTag<hwy::float16_t, 4> df16;
   const FixedTag<uint16_t, 4> du16;
   using V32 = Vec<decltype(df32)>;
-  using V16 = Vec<decltype(df16)>;
   const Rebind<hwy::float16_t, FixedTag<float, 4>> dfc16;
   uint32_t x = 0;
   int pixelsCount = 4;
@@ -103,6 +103,34 @@ RgbaF32ToF16H(const float *JXL_RESTRICT src, const int srcStride, uint16_t *JXL_
                        width);
   }
 }
+
+void F32ToF16RowHWY(const float *JXL_RESTRICT src, uint16_t *JXL_RESTRICT dst, const uint32_t count) {
+  const FixedTag<float, 4> df32;
+  const FixedTag<uint16_t, 4> du16;
+  const Rebind<hwy::float16_t, FixedTag<float, 4>> dfc16;
+  uint32_t x = 0;
+  for (; x + 4 <= count; x += 4) {
+    StoreU(BitCast(du16, DemoteTo(dfc16, LoadU(df32, src + x))), du16, dst + x);
+  }
+
+  for (; x < count; ++x) {
+    dst[x] = half(src[x]).data_;
+  }
+}
+
+void
+F32ToF16H(const float *JXL_RESTRICT src, const uint32_t srcStride, uint16_t *JXL_RESTRICT dst,
+          const uint32_t dstStride, const uint32_t width, const uint32_t height,
+          const uint32_t components) {
+  auto srcPixels = reinterpret_cast<const uint8_t *>(src);
+  auto dstPixels = reinterpret_cast<uint8_t *>(dst);
+
+  for (uint32_t y = 0; y < height; ++y) {
+    F32ToF16RowHWY(reinterpret_cast<const float *>(srcPixels + srcStride * y),
+                   reinterpret_cast<uint16_t *>(dstPixels + dstStride * y),
+                   width * components);
+  }
+}
 }
 
 HWY_AFTER_NAMESPACE();
@@ -152,6 +180,14 @@ RgbaF32ToF16(const float *JXL_RESTRICT src, const uint32_t srcStride, uint16_t *
              const uint32_t height) {
   HWY_DYNAMIC_DISPATCH(RgbaF32ToF16H)(src, srcStride, dst, dstStride, width, height);
 }
+
+HWY_EXPORT(F32ToF16H);
+HWY_DLLEXPORT void
+F32ToF16(const float *JXL_RESTRICT src, const uint32_t srcStride, uint16_t *JXL_RESTRICT dst,
+         const uint32_t dstStride, const uint32_t width, const uint32_t height,
+         const uint32_t components) {
+  HWY_DYNAMIC_DISPATCH(F32ToF16H)(src, srcStride, dst, dstStride, width, height, components);
+}
 }
 
 #endif
@@ -40,6 +40,17 @@ void RgbaF32ToF16(const float *JXL_RESTRICT src,
                   const uint32_t dstStride,
                   const uint32_t width,
                   const uint32_t height);
+
+/**
+ * Converts rows of any channels count, every sample is demoted independently.
+ */
+void F32ToF16(const float *JXL_RESTRICT src,
+              const uint32_t srcStride,
+              uint16_t *JXL_RESTRICT dst,
+              const uint32_t dstStride,
+              const uint32_t width,
+              const uint32_t height,
+              const uint32_t components);
 }
 
 float half_to_float(const uint16_t x);
@@ -147,72 +147,84 @@ void UnpremultiplyRGBA_HWY(const uint8_t *JXL_RESTRICT src, const uint32_t srcSt
   }
 }
 
-void PremultiplyRGBA_HWY(const uint8_t *JXL_RESTRICT src, const uint32_t srcStride,
-                         uint8_t *JXL_RESTRICT dst, const uint32_t dstStride, const uint32_t width,
-                         const uint32_t height) {
-  for (uint32_t y = 0; y < height; ++y) {
-    const FixedTag<uint8_t, 16> du8x16;
-    const FixedTag<uint16_t, 8> du16x8;
-    const FixedTag<uint8_t, 8> du8x8;
+// Every block is loaded before it is stored, so src and dst may be the same row
+void PremultiplyRGBARow(const uint8_t *src, uint8_t *dst, const uint32_t width) {
+  const FixedTag<uint8_t, 16> du8x16;
+  const FixedTag<uint16_t, 8> du16x8;
+  const FixedTag<uint8_t, 8> du8x8;
 
-    using VU8x16 = Vec<decltype(du8x16)>;
-    using VU16x8 = Vec<decltype(du16x8)>;
+  using VU8x16 = Vec<decltype(du8x16)>;
+  using VU16x8 = Vec<decltype(du16x8)>;
 
-    auto mSrc = reinterpret_cast<const uint8_t *>(src);
-    auto mDst = reinterpret_cast<uint8_t *>(dst);
+  auto mSrc = src;
+  auto mDst = dst;
 
-    int x = 0;
-    const int pixels = 16;
+  int x = 0;
+  const int pixels = 16;
 
-    for (; x + pixels < width; x += pixels) {
-      VU8x16 r8, g8, b8, a8;
-      LoadInterleaved4(du8x16, mSrc, r8, g8, b8, a8);
+  for (; x + pixels < width; x += pixels) {
+    VU8x16 r8, g8, b8, a8;
+    LoadInterleaved4(du8x16, mSrc, r8, g8, b8, a8);
 
-      VU16x8 rh = PromoteUpperTo(du16x8, r8);
-      VU16x8 gh = PromoteUpperTo(du16x8, g8);
-      VU16x8 bh = PromoteUpperTo(du16x8, b8);
-      VU16x8 ah = PromoteUpperTo(du16x8, a8);
+    VU16x8 rh = PromoteUpperTo(du16x8, r8);
+    VU16x8 gh = PromoteUpperTo(du16x8, g8);
+    VU16x8 bh = PromoteUpperTo(du16x8, b8);
+    VU16x8 ah = PromoteUpperTo(du16x8, a8);
 
-      rh = DivBy255(du16x8, Mul(rh, ah));
-      gh = DivBy255(du16x8, Mul(gh, ah));
-      bh = DivBy255(du16x8, Mul(bh, ah));
+    rh = DivBy255(du16x8, Mul(rh, ah));
+    gh = DivBy255(du16x8, Mul(gh, ah));
+    bh = DivBy255(du16x8, Mul(bh, ah));
 
-      VU16x8 rl = PromoteLowerTo(du16x8, r8);
-      VU16x8 gl = PromoteLowerTo(du16x8, g8);
-      VU16x8 bl = PromoteLowerTo(du16x8, b8);
-      VU16x8 al = PromoteLowerTo(du16x8, a8);
+    VU16x8 rl = PromoteLowerTo(du16x8, r8);
+    VU16x8 gl = PromoteLowerTo(du16x8, g8);
+    VU16x8 bl = PromoteLowerTo(du16x8, b8);
+    VU16x8 al = PromoteLowerTo(du16x8, a8);
 
-      rl = DivBy255(du16x8, Mul(rl, al));
-      gl = DivBy255(du16x8, Mul(gl, al));
-      bl = DivBy255(du16x8, Mul(bl, al));
+    rl = DivBy255(du16x8, Mul(rl, al));
+    gl = DivBy255(du16x8, Mul(gl, al));
+    bl = DivBy255(du16x8, Mul(bl, al));
 
-      r8 = Combine(du8x16, DemoteTo(du8x8, rh), DemoteTo(du8x8, rl));
-      g8 = Combine(du8x16, DemoteTo(du8x8, gh), DemoteTo(du8x8, gl));
-      b8 = Combine(du8x16, DemoteTo(du8x8, bh), DemoteTo(du8x8, bl));
+    r8 = Combine(du8x16, DemoteTo(du8x8, rh), DemoteTo(du8x8, rl));
+    g8 = Combine(du8x16, DemoteTo(du8x8, gh), DemoteTo(du8x8, gl));
+    b8 = Combine(du8x16, DemoteTo(du8x8, bh), DemoteTo(du8x8, bl));
 
-      StoreInterleaved4(r8, g8, b8, a8, du8x16, mDst);
+    StoreInterleaved4(r8, g8, b8, a8, du8x16, mDst);
 
-      mSrc += pixels * 4;
-      mDst += pixels * 4;
-    }
+    mSrc += pixels * 4;
+    mDst += pixels * 4;
+  }
 
-    for (; x < width; ++x) {
-      uint8_t alpha = mSrc[3];
-      mDst[0] = (static_cast<uint16_t>(mSrc[0]) * static_cast<uint16_t>(alpha))
-          / static_cast<uint16_t >(255);
-      mDst[1] = (static_cast<uint16_t>(mSrc[1]) * static_cast<uint16_t>(alpha))
-          / static_cast<uint16_t >(255);
-      mDst[2] = (static_cast<uint16_t>(mSrc[2]) * static_cast<uint16_t>(alpha))
-          / static_cast<uint16_t >(255);
-      mDst[3] = alpha;
-      mSrc += 4;
-      mDst += 4;
-    }
+  for (; x < width; ++x) {
+    uint8_t alpha = mSrc[3];
+    mDst[0] = (static_cast<uint16_t>(mSrc[0]) * static_cast<uint16_t>(alpha))
+        / static_cast<uint16_t >(255);
+    mDst[1] = (static_cast<uint16_t>(mSrc[1]) * static_cast<uint16_t>(alpha))
+        / static_cast<uint16_t >(255);
+    mDst[2] = (static_cast<uint16_t>(mSrc[2]) * static_cast<uint16_t>(alpha))
+        / static_cast<uint16_t >(255);
+    mDst[3] = alpha;
+    mSrc += 4;
+    mDst += 4;
+  }
+}
 
+void PremultiplyRGBA_HWY(const uint8_t *JXL_RESTRICT src, const uint32_t srcStride,
+                         uint8_t *JXL_RESTRICT dst, const uint32_t dstStride, const uint32_t width,
+                         const uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    PremultiplyRGBARow(src, dst, width);
     src += srcStride;
     dst += dstStride;
   }
 }
+
+void PremultiplyRGBAInPlace_HWY(uint8_t *data, const uint32_t stride, const uint32_t width,
+                                const uint32_t height) {
+  for (uint32_t y = 0; y < height; ++y) {
+    PremultiplyRGBARow(data, data, width);
+    data += stride;
+  }
+}
 }
 
 HWY_AFTER_NAMESPACE();
@@ -221,6 +233,7 @@ HWY_AFTER_NAMESPACE();
 namespace coder {
 HWY_EXPORT(UnpremultiplyRGBA_HWY);
 HWY_EXPORT(PremultiplyRGBA_HWY);
+HWY_EXPORT(PremultiplyRGBAInPlace_HWY);
 
 HWY_DLLEXPORT void UnpremultiplyRGBA(const uint8_t *JXL_RESTRICT src, uint32_t srcStride,
                                      uint8_t *JXL_RESTRICT dst, uint32_t dstStride, uint32_t width,
@@ -233,5 +246,9 @@ HWY_DLLEXPORT void PremultiplyRGBA(const uint8_t *JXL_RESTRICT src, uint32_t src
                                    uint32_t height) {
   HWY_DYNAMIC_DISPATCH(PremultiplyRGBA_HWY)(src, srcStride, dst, dstStride, width, height);
 }
+
+HWY_DLLEXPORT void PremultiplyRGBA(uint8_t *data, uint32_t stride, uint32_t width, uint32_t height) {
+  HWY_DYNAMIC_DISPATCH(PremultiplyRGBAInPlace_HWY)(data, stride, width, height);
+}
 }
 #endif
\ No newline at end of file
@@ -16,6 +16,11 @@ void UnpremultiplyRGBA(const uint8_t *JXL_RESTRICT src, uint32_t srcStride,
 void PremultiplyRGBA(const uint8_t *JXL_RESTRICT src, uint32_t srcStride,
                      uint8_t *JXL_RESTRICT dst, uint32_t dstStride, uint32_t width,
                      uint32_t height);
+
+/**
+ * Premultiplies pixels where they are, src and dst of the variant above must not overlap
+ */
+void PremultiplyRGBA(uint8_t *data, uint32_t stride, uint32_t width, uint32_t height);
 }
 
 #endif //JXLCODER_RGBALPHA_H
@@ -29,8 +29,119 @@
 #include "JxlDecoding.h"
 #include "jxl/decode.h"
 #include "jxl/decode_cxx.h"
+#include "jxl/encode.h"
+#include "jxl/cms.h"
 #include "jxl/resizable_parallel_runner.h"
 #include "jxl/resizable_parallel_runner_cxx.h"
+#include "processing/StreamingResampler.h"
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+static void *JxlSampledInit(void *initOpaque, size_t numThreads, size_t /* numPixelsPerThread */) {
+  auto resampler = reinterpret_cast<coder::StreamingResampler *>(initOpaque);
+  resampler->prepare(numThreads);
+  return resampler;
+}
+
+static void JxlSampledRun(void *runOpaque, size_t threadId,
+                          size_t x, size_t y, size_t numPixels, const void *pixels) {
+  auto resampler = reinterpret_cast<coder::StreamingResampler *>(runOpaque);
+  resampler->pushRow(threadId, static_cast<int>(x), static_cast<int>(y),
+                     static_cast<int>(numPixels), pixels);
+}
+
+static void JxlSampledDestroy(void * /* runOpaque */) {
+}
+
+// libjxl writes pixels already oriented, these swap width and height of the stored image
+static bool JxlIsTransposed(JxlOrientation orientation) {
+  return orientation == JXL_ORIENT_TRANSPOSE || orientation == JXL_ORIENT_ROTATE_90_CW
+      || orientation == JXL_ORIENT_ANTI_TRANSPOSE || orientation == JXL_ORIENT_ROTATE_90_CCW;
+}
+
+static bool JxlIsAdaptableEncoding(const JxlColorEncoding &clr) {
+  return clr.color_space == JXL_COLOR_SPACE_RGB && clr.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
+      clr.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
+      clr.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
+      clr.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
+      clr.transfer_function == JXL_TRANSFER_FUNCTION_SRGB ||
+      clr.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA;
+}
+
+bool JxlReadColorProfile(JxlDecoder *dec, std::vector<uint8_t> *iccProfile,
+                         bool *preferEncoding, JxlColorEncoding *colorEncoding) {
+  // Get the ICC color profile of the pixel data
+  size_t iccSize;
+  if (JXL_DEC_SUCCESS !=
+      JxlDecoderGetICCProfileSize(dec, JXL_COLOR_PROFILE_TARGET_DATA, &iccSize)) {
+    return false;
+  }
+  *preferEncoding = false;
+  JxlColorEncoding clr;
+  if (JXL_DEC_SUCCESS ==
+      JxlDecoderGetColorAsEncodedProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA, &clr)) {
+    *colorEncoding = clr;
+    if (JxlIsAdaptableEncoding(clr)) {
+      *preferEncoding = true;
+    }
+  }
+  if (!(*preferEncoding)) {
+    iccProfile->resize(iccSize);
+    if (JXL_DEC_SUCCESS != JxlDecoderGetColorAsICCProfile(
+        dec, JXL_COLOR_PROFILE_TARGET_DATA,
+        iccProfile->data(), iccProfile->size())) {
+      return false;
+    }
+  } else {
+    iccProfile->clear();
+  }
+  return true;
+}
+
+bool JxlAttachCms(JxlDecoder *dec) {
+  const JxlCmsInterface *cms = JxlGetDefaultCms();
+  if (!cms) {
+    return false;
+  }
+  return JXL_DEC_SUCCESS == JxlDecoderSetCms(dec, *cms);
+}
+
+bool JxlResolveColorProfile(JxlDecoder *dec, bool cmsAttached, bool grayscale,
+                            std::vector<uint8_t> *iccProfile,
+                            bool *preferEncoding, JxlColorEncoding *colorEncoding) {
+  JxlColorEncoding original;
+  bool adaptable = JXL_DEC_SUCCESS ==
+      JxlDecoderGetColorAsEncodedProfile(dec, JXL_COLOR_PROFILE_TARGET_ORIGINAL, &original)
+      && JxlIsAdaptableEncoding(original);
+  if (cmsAttached && !adaptable) {
+    JxlColorEncoding srgb;
+    JxlColorEncodingSetToSRGB(&srgb, grayscale ? JXL_TRUE : JXL_FALSE);
+    if (JXL_DEC_SUCCESS == JxlDecoderSetOutputColorProfile(dec, &srgb, nullptr, 0)) {
+      // Conversion is fused into the libjxl rendering pipeline, pixels arrive in sRGB
+      iccProfile->clear();
+      *preferEncoding = false;
+      *colorEncoding = srgb;
+      return true;
+    }
+  }
+  return JxlReadColorProfile(dec, iccProfile, preferEncoding, colorEncoding);
+}
+
+bool JxlCreateDecoderSession(JxlDecoderSession *session) {
+  session->runner = JxlResizableParallelRunnerMake(nullptr);
+  session->decoder = JxlDecoderMake(nullptr);
+  return session->runner && session->decoder;
+}
+
+static int JxlSampleSize(JxlDataType dataType) {
+  switch (dataType) {
+    case JXL_TYPE_FLOAT: return static_cast<int>(sizeof(float));
+    case JXL_TYPE_UINT16:
+    case JXL_TYPE_FLOAT16: return static_cast<int>(sizeof(uint16_t));
+    default: return static_cast<int>(sizeof(uint8_t));
+  }
+}
 
 bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                          std::vector<uint8_t> *pixels, size_t *xsize,
@@ -41,42 +152,103 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                          bool *preferEncoding,
                          JxlColorEncoding *colorEncoding,
                          bool *hasAlphaInOrigin) {
-  auto runner = JxlResizableParallelRunnerMake(nullptr);
+  bool sampled = false;
+  return DecodeJpegXlSampled(jxl, size, pixels, xsize, ysize, iccProfile, useFloats, bitDepth,
+                             alphaPremultiplied, allowedFloats, jxlOrientation, preferEncoding,
+                             colorEncoding, hasAlphaInOrigin, nullptr, &sampled);
+}
+
+bool DecodeJpegXlSampled(const uint8_t *jxl, size_t size,
+                         std::vector<uint8_t> *pixels, size_t *xsize,
+                         size_t *ysize, std::vector<uint8_t> *iccProfile,
+                         bool *useFloats, int *bitDepth,
+                         bool *alphaPremultiplied, bool allowedFloats,
+                         JxlOrientation *jxlOrientation,
+                         bool *preferEncoding,
+                         JxlColorEncoding *colorEncoding,
+                         bool *hasAlphaInOrigin,
+                         const JxlSamplePlanner &planner,
+                         bool *sampled,
+                         int *components,
+                         bool *float32) {
+  JxlDecodeTarget direct;
+  return DecodeJpegXlInto(jxl, size, pixels, xsize, ysize, iccProfile, useFloats, bitDepth,
+                          alphaPremultiplied, allowedFloats, jxlOrientation, preferEncoding,
+                          colorEncoding, hasAlphaInOrigin, planner, sampled, nullptr, &direct,
+                          components, float32, nullptr);
+}
+
+bool DecodeJpegXlInto(const uint8_t *jxl, size_t size,
+                      std::vector<uint8_t> *pixels, size_t *xsize,
+                      size_t *ysize, std::vector<uint8_t> *iccProfile,
+                      bool *useFloats, int *bitDepth,
+                      bool *alphaPremultiplied, bool allowedFloats,
+                      JxlOrientation *jxlOrientation,
+                      bool *preferEncoding,
+                      JxlColorEncoding *colorEncoding,
+                      bool *hasAlphaInOrigin,
+                      const JxlSamplePlanner &planner,
+                      bool *sampled,
+                      const JxlTargetProvider &provider,
+                      JxlDecodeTarget *direct,
+                      int *components,
+                      bool *float32,
+                      JxlDecoderSession *session) {
+  JxlDecoderSession ownSession;
+  if (!session) {
+    if (!JxlCreateDecoderSession(&ownSession)) {
+      return false;
+    }
+    session = &ownSession;
+  } else {
+    // Reset drops every setting, the worker pool itself stays alive
+    JxlDecoderReset(session->decoder.get());
+  }
+  JxlDecoder *dec = session->decoder.get();
+  void *runner = session->runner.get();
 
-  auto dec = JxlDecoderMake(nullptr);
   if (JXL_DEC_SUCCESS !=
-      JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO |
+      JxlDecoderSubscribeEvents(dec, JXL_DEC_BASIC_INFO |
           JXL_DEC_COLOR_ENCODING |
           JXL_DEC_FULL_IMAGE)) {
     return false;
   }
 
-  if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(),
+  if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec,
                                                      JxlResizableParallelRunner,
-                                                     runner.get())) {
+                                                     runner)) {
     return false;
   }
 
+  bool cmsAttached = JxlAttachCms(dec);
+
   JxlBasicInfo info;
   JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
 
-  JxlDecoderSetInput(dec.get(), jxl, size);
-  JxlDecoderCloseInput(dec.get());
+  JxlDecoderSetInput(dec, jxl, size);
+  JxlDecoderCloseInput(dec);
 
   bool useBitmapHalfFloats = false;
+  bool useFloat32 = false;
   *preferEncoding = false;
+  *sampled = false;
+  direct->data = nullptr;
+  direct->stride = 0;
+
+  JxlSampledTarget target;
+  std::unique_ptr<coder::StreamingResampler> resampler;
 
   *hasAlphaInOrigin = true;
 
   for (;;) {
-    JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+    JxlDecoderStatus status = JxlDecoderProcessInput(dec);
 
     if (status == JXL_DEC_ERROR) {
       return false;
     } else if (status == JXL_DEC_NEED_MORE_INPUT) {
       return false;
     } else if (status == JXL_DEC_BASIC_INFO) {
-      if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec.get(), &info)) {
+      if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec, &info)) {
         return false;
       }
       *xsize = info.xsize;
@@ -87,60 +259,134 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
       if (info.bits_per_sample > 8 && allowedFloats) {
         *useFloats = true;
         useBitmapHalfFloats = true;
-        format = {4, JXL_TYPE_FLOAT16, JXL_NATIVE_ENDIAN, 0};
+        // Float samples keep the precision through colour management and scaling,
+        // bitmap destinations are always half floats
+        useFloat32 = float32 != nullptr;
+        format = {4, useFloat32 ? JXL_TYPE_FLOAT : JXL_TYPE_FLOAT16, JXL_NATIVE_ENDIAN, 0};
       } else {
         *useFloats = false;
         useBitmapHalfFloats = false;
       }
       *hasAlphaInOrigin = info.num_extra_channels > 0 && info.alpha_bits > 0;
+      if (components) {
+        // Gray or opaque images are kept in their own layout through the whole pipeline
+        format.num_channels = info.num_color_channels + (*hasAlphaInOrigin ? 1 : 0);
+      }
+      // Image out callbacks deliver oriented pixels, so the target is planned on the oriented size
+      const bool transposed = JxlIsTransposed(info.orientation);
+      if (planner && planner(transposed ? info.ysize : info.xsize, transposed ? info.xsize : info.ysize,
+                             &target)) {
+        if (target.width <= 0 || target.height <= 0 || target.srcWidth <= 0 || target.srcHeight <= 0) {
+          return false;
+        }
+        *sampled = true;
+      }
       JxlResizableParallelRunnerSetThreads(
-          runner.get(),
+          runner,
           JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
     } else if (status == JXL_DEC_COLOR_ENCODING) {
-      // Get the ICC color profile of the pixel data
-      size_t iccSize;
-      if (JXL_DEC_SUCCESS !=
-          JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,&iccSize)) {
+      if (!JxlResolveColorProfile(dec, cmsAttached, info.num_color_channels == 1,
+                                  iccProfile, preferEncoding, colorEncoding)) {
         return false;
       }
-      JxlColorEncoding clr;
-      if (JXL_DEC_SUCCESS ==
-          JxlDecoderGetColorAsEncodedProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,&clr)) {
-        *colorEncoding = clr;
-        if (clr.color_space == JXL_COLOR_SPACE_RGB && clr.transfer_function == JXL_TRANSFER_FUNCTION_HLG ||
-            clr.transfer_function == JXL_TRANSFER_FUNCTION_PQ ||
-            clr.transfer_function == JXL_TRANSFER_FUNCTION_DCI ||
-            clr.transfer_function == JXL_TRANSFER_FUNCTION_709 ||
-            clr.transfer_function == JXL_TRANSFER_FUNCTION_SRGB ||
-            clr.transfer_function == JXL_TRANSFER_FUNCTION_GAMMA) {
-          *preferEncoding = true;
-        }
-      }
-      if (!(*preferEncoding)) {
-        iccProfile->resize(iccSize);
-        if (JXL_DEC_SUCCESS != JxlDecoderGetColorAsICCProfile(
-            dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-            iccProfile->data(), iccProfile->size())) {
+    } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER && *sampled) {
+      if (!direct->data && provider
+          && provider(target.width, target.height, useBitmapHalfFloats, direct)) {
+        if (!direct->data) {
           return false;
         }
+      }
+      // Provided destinations are always RGBA
+      uint32_t channels = direct->data ? 4 : format.num_channels;
+      // Straight alpha is filtered premultiplied. 8 bit output stays premultiplied
+      // when no colour stage runs after decoding, then nothing premultiplies it again
+      XAlphaMode alphaMode = alphaAsIs;
+      if (*hasAlphaInOrigin && !info.alpha_premultiplied) {
+        const bool colorsFinal = iccProfile->empty() && !*preferEncoding && !useBitmapHalfFloats;
+        alphaMode = colorsFinal ? alphaPremultiplyOutput : alphaStraight;
+        *alphaPremultiplied = colorsFinal;
+      }
+      // Linear light decodes with the sRGB curve, pixels still waiting for their ICC profile or
+      // for adaptation from another transfer function are filtered as they are
+      const bool linearLight = target.linearLight && iccProfile->empty()
+          && (!*preferEncoding || colorEncoding->transfer_function == JXL_TRANSFER_FUNCTION_SRGB);
+      // Source rows wait for their remaining fragments in the output sample type,
+      // the same precision a full size decode would keep
+      JxlDataType sampleType = JXL_TYPE_UINT8;
+      coder::StreamingSample sample = coder::streamingU8;
+      if (useFloat32 && !direct->data) {
+        sampleType = JXL_TYPE_FLOAT;
+        sample = coder::streamingF32;
+      } else if (useBitmapHalfFloats) {
+        sampleType = JXL_TYPE_FLOAT16;
+        sample = coder::streamingF16;
+      }
+      // Animation frames after the first one replace the previous output
+      resampler = std::make_unique<coder::StreamingResampler>(target.srcX, target.srcY,
+                                                              target.srcWidth, target.srcHeight,
+                                                              target.scaledWidth, target.scaledHeight,
+                                                              target.x, target.y,
+                                                              target.width, target.height,
+                                                              static_cast<int>(channels), target.sampler,
+                                                              linearLight, alphaMode, sample);
+      if (direct->data) {
+        resampler->setOutput(direct->data, direct->stride, sample);
       } else {
-        iccProfile->clear();
+        const size_t stride = static_cast<size_t>(target.width) * channels * JxlSampleSize(sampleType);
+        pixels->resize(stride * target.height);
+        resampler->setOutput(pixels->data(), stride, sample);
+      }
+      JxlPixelFormat callbackFormat = {channels, sampleType, JXL_NATIVE_ENDIAN, 0};
+      if (JXL_DEC_SUCCESS != JxlDecoderSetMultithreadedImageOutCallback(dec, &callbackFormat,
+                                                                        JxlSampledInit,
+                                                                        JxlSampledRun,
+                                                                        JxlSampledDestroy,
+                                                                        resampler.get())) {
+        return false;
       }
     } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
       size_t bufferSize;
+      const bool transposed = JxlIsTransposed(info.orientation);
+      const size_t orientedWidth = transposed ? *ysize : *xsize;
+      const size_t orientedHeight = transposed ? *xsize : *ysize;
+      if (!direct->data && provider
+          && provider(orientedWidth, orientedHeight, useBitmapHalfFloats, direct)) {
+        if (!direct->data) {
+          return false;
+        }
+      }
+      if (direct->data) {
+        // Alignment equal to the stride makes libjxl write rows with exactly the destination stride
+        JxlPixelFormat directFormat = format;
+        directFormat.num_channels = 4;
+        directFormat.data_type = useBitmapHalfFloats ? JXL_TYPE_FLOAT16 : JXL_TYPE_UINT8;
+        directFormat.align = direct->stride;
+        if (JXL_DEC_SUCCESS !=
+            JxlDecoderImageOutBufferSize(dec, &directFormat, &bufferSize)) {
+          return false;
+        }
+        if (bufferSize > direct->stride * orientedHeight) {
+          return false;
+        }
+        if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec, &directFormat,
+                                                           direct->data,
+                                                           bufferSize)) {
+          return false;
+        }
+        continue;
+      }
       if (JXL_DEC_SUCCESS !=
-          JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
+          JxlDecoderImageOutBufferSize(dec, &format, &bufferSize)) {
         return false;
       }
-      int stride = (int) *xsize * 4 *
-          (int) (useBitmapHalfFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+      int stride = (int) *xsize * (int) format.num_channels * JxlSampleSize(format.data_type);
       if (bufferSize != stride * (*ysize)) {
         return false;
       }
       pixels->resize(stride * (*ysize));
       void *pixelsBuffer = (void *) pixels->data();
       size_t pixelsBufferSize = pixels->size();
-      if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(), &format,
+      if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec, &format,
                                                          pixelsBuffer,
                                                          pixelsBufferSize)) {
         return false;
@@ -150,8 +396,22 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
       // full frames may be decoded. This example only keeps the last one.
     } else if (status == JXL_DEC_SUCCESS) {
       // All decoding successfully finished.
-      // It's not required to call JxlDecoderReleaseInput(dec.get()) here since
+      // It's not required to call JxlDecoderReleaseInput(dec) here since
       // the decoder will be destroyed.
+      if (*sampled) {
+        // Rows were written as their vertical windows completed
+        if (!resampler || !resampler->isComplete()) {
+          return false;
+        }
+        *xsize = resampler->getWidth();
+        *ysize = resampler->getHeight();
+      }
+      if (components) {
+        *components = direct->data ? 4 : static_cast<int>(format.num_channels);
+      }
+      if (float32) {
+        *float32 = useFloat32 && !direct->data;
+      }
       return true;
     } else {
       return false;
@@ -159,52 +419,164 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
   }
 }
 
-bool DecodeBasicInfo(const uint8_t *jxl, size_t size, size_t *xsize,
-                     size_t *ysize) {
-  // Multi-threaded parallel runner.
-  auto runner = JxlResizableParallelRunnerMake(nullptr);
+bool DecodeJpegXlRegion(const uint8_t *jxl, size_t size,
+                        std::vector<uint8_t> *pixels, size_t *xsize,
+                        size_t *ysize, std::vector<uint8_t> *iccProfile,
+                        bool *useFloats, int *bitDepth,
+                        bool *alphaPremultiplied, bool allowedFloats,
+                        JxlOrientation *jxlOrientation,
+                        bool *preferEncoding,
+                        JxlColorEncoding *colorEncoding,
+                        bool *hasAlphaInOrigin,
+                        const JxlRegion &region,
+                        XSampler sampler,
+                        int *components,
+                        bool *float32) {
+  JxlSamplePlanner planner = [&](size_t imageWidth, size_t imageHeight, JxlSampledTarget *target) {
+    int left = std::clamp(region.x, 0, static_cast<int>(imageWidth));
+    int top = std::clamp(region.y, 0, static_cast<int>(imageHeight));
+    int right = std::clamp(region.x + region.width, 0, static_cast<int>(imageWidth));
+    int bottom = std::clamp(region.y + region.height, 0, static_cast<int>(imageHeight));
+    target->srcX = left;
+    target->srcY = top;
+    target->srcWidth = right - left;
+    target->srcHeight = bottom - top;
+    float scale = std::clamp(region.scale, 0.f, 1.f);
+    target->scaledWidth = std::max(static_cast<int>(std::round(static_cast<float>(target->srcWidth) * scale)), 1);
+    target->scaledHeight = std::max(static_cast<int>(std::round(static_cast<float>(target->srcHeight) * scale)), 1);
+    target->x = 0;
+    target->y = 0;
+    target->width = target->scaledWidth;
+    target->height = target->scaledHeight;
+    // Unscaled regions are copied as is
+    target->sampler = scale == 1.f ? nearest : sampler;
+    return true;
+  };
+  bool sampled = false;
+  return DecodeJpegXlSampled(jxl, size, pixels, xsize, ysize, iccProfile, useFloats, bitDepth,
+                             alphaPremultiplied, allowedFloats, jxlOrientation, preferEncoding,
+                             colorEncoding, hasAlphaInOrigin, planner, &sampled, components, float32);
+}
 
+bool ProbeJpegXl(const JxlInputReader &reader, size_t totalSize, bool countFrames, JxlImageProbe *probe) {
   auto dec = JxlDecoderMake(nullptr);
+  if (!dec) {
+    return false;
+  }
   if (JXL_DEC_SUCCESS !=
       JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO |
           JXL_DEC_COLOR_ENCODING |
-          JXL_DEC_FULL_IMAGE)) {
+          (countFrames ? JXL_DEC_FRAME : 0))) {
     return false;
   }
-
-  if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(),
-                                                     JxlResizableParallelRunner,
-                                                     runner.get())) {
+  // Orientation is reported as stored, display size is computed below
+  if (JXL_DEC_SUCCESS != JxlDecoderSetKeepOrientation(dec.get(), JXL_TRUE)) {
     return false;
   }
 
+  std::vector<uint8_t> input;
+  size_t offset = 0;
+  size_t request = std::max(JxlDecoderSizeHintBasicInfo(dec.get()), static_cast<size_t>(64));
+  bool inputAttached = false;
+  bool hasBasicInfo = false;
   JxlBasicInfo info;
 
-  JxlDecoderSetInput(dec.get(), jxl, size);
-  JxlDecoderCloseInput(dec.get());
+  *probe = {};
+  probe->numberOfFrames = 0;
 
   for (;;) {
-    JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
-
+    JxlDecoderStatus status = inputAttached ? JxlDecoderProcessInput(dec.get()) : JXL_DEC_NEED_MORE_INPUT;
     if (status == JXL_DEC_ERROR) {
       return false;
     } else if (status == JXL_DEC_NEED_MORE_INPUT) {
-      return false;
+      if (offset >= totalSize) {
+        return false;
+      }
+      if (inputAttached) {
+        size_t remaining = JxlDecoderReleaseInput(dec.get());
+        input.erase(input.begin(), input.end() - static_cast<std::ptrdiff_t>(remaining));
+      }
+      if (!hasBasicInfo) {
+        size_t hint = JxlDecoderSizeHintBasicInfo(dec.get());
+        request = std::max(hint > input.size() ? hint - input.size() : 0, request);
+      }
+      size_t chunk = std::min(request, totalSize - offset);
+      size_t previousSize = input.size();
+      input.resize(previousSize + chunk);
+      size_t read = reader(offset, chunk, input.data() + previousSize);
+      if (read == 0) {
+        return false;
+      }
+      input.resize(previousSize + read);
+      offset += read;
+      // Headers past the basic info, e.g. a large ICC or frame headers, are fetched with growing chunks
+      request *= 2;
+      if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), input.data(), input.size())) {
+        return false;
+      }
+      if (offset >= totalSize) {
+        JxlDecoderCloseInput(dec.get());
+      }
+      inputAttached = true;
     } else if (status == JXL_DEC_BASIC_INFO) {
       if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec.get(), &info)) {
         return false;
       }
-      *xsize = info.xsize;
-      *ysize = info.ysize;
-      return true;
-    } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
-      return false;
-    } else if (status == JXL_DEC_FULL_IMAGE) {
-      return false;
+      hasBasicInfo = true;
+      probe->orientation = info.orientation;
+      bool transposed = JxlIsTransposed(info.orientation);
+      probe->width = transposed ? info.ysize : info.xsize;
+      probe->height = transposed ? info.xsize : info.ysize;
+      probe->bitsPerSample = info.bits_per_sample;
+      probe->exponentBitsPerSample = info.exponent_bits_per_sample;
+      probe->hasAlpha = info.num_extra_channels > 0 && info.alpha_bits > 0;
+      probe->alphaPremultiplied = info.alpha_premultiplied;
+      probe->animated = info.have_animation;
+      probe->loopsCount = info.have_animation ? static_cast<int>(info.animation.num_loops) : -1;
+    } else if (status == JXL_DEC_COLOR_ENCODING) {
+      JxlColorEncoding clr;
+      if (JXL_DEC_SUCCESS ==
+          JxlDecoderGetColorAsEncodedProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_ORIGINAL, &clr)) {
+        probe->hasColorEncoding = true;
+        probe->colorEncoding = clr;
+      }
+      size_t iccSize = 0;
+      if (JXL_DEC_SUCCESS ==
+          JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_ORIGINAL, &iccSize)) {
+        probe->iccSize = iccSize;
+      }
+      if (!countFrames || !info.have_animation) {
+        probe->numberOfFrames = 1;
+        return true;
+      }
+    } else if (status == JXL_DEC_FRAME) {
+      JxlFrameHeader header;
+      if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(dec.get(), &header)) {
+        return false;
+      }
+      probe->numberOfFrames += 1;
+      if (header.is_last) {
+        return true;
+      }
     } else if (status == JXL_DEC_SUCCESS) {
-      return false;
+      return hasBasicInfo;
     } else {
       return false;
     }
   }
-}
\ No newline at end of file
+}
+
+bool DecodeBasicInfo(const uint8_t *jxl, size_t size, size_t *xsize,
+                     size_t *ysize) {
+  JxlImageProbe probe;
+  JxlInputReader reader = [&](size_t offset, size_t count, uint8_t *dst) {
+    std::copy(jxl + offset, jxl + offset + count, dst);
+    return count;
+  };
+  if (!ProbeJpegXl(reader, size, false, &probe)) {
+    return false;
+  }
+  *xsize = probe.width;
+  *ysize = probe.height;
+  return true;
+}
@@ -29,8 +29,62 @@
 #pragma once
 
 #include <vector>
+#include <functional>
 #include "codestream_header.h"
 #include "color_encoding.h"
+#include "XScaler.h"
+#include "decode.h"
+#include "jxl/decode_cxx.h"
+#include "jxl/resizable_parallel_runner_cxx.h"
+
+/**
+ * Describes a downscaled decode: the source region [srcX, srcX + srcWidth) x [srcY, srcY + srcHeight)
+ * is resampled to scaledWidth x scaledHeight and only the window [x, x + width) x [y, y + height)
+ * of it is produced.
+ */
+struct JxlSampledTarget {
+  int srcX;
+  int srcY;
+  int srcWidth;
+  int srcHeight;
+  int scaledWidth;
+  int scaledHeight;
+  int x;
+  int y;
+  int width;
+  int height;
+  XSampler sampler;
+  // Resample in linear light, see StreamingResampler. Honoured only when pixels arrive sRGB encoded
+  bool linearLight = false;
+};
+
+/**
+ * Called once basic info is known with the oriented image size,
+ * returns false when the image should be decoded at full size.
+ */
+typedef std::function<bool(size_t xsize, size_t ysize, JxlSampledTarget *target)> JxlSamplePlanner;
+
+/**
+ * Reads the data colour profile once JXL_DEC_COLOR_ENCODING was received.
+ * Profiles libjxl can describe with a supported transfer function set preferEncoding
+ * and are handled by GamutAdapter, any other is returned as ICC.
+ */
+bool JxlReadColorProfile(JxlDecoder *dec, std::vector<uint8_t> *iccProfile,
+                         bool *preferEncoding, JxlColorEncoding *colorEncoding);
+
+/**
+ * Attaches the libjxl default CMS, has to be done before decoding starts.
+ */
+bool JxlAttachCms(JxlDecoder *dec);
+
+/**
+ * Same as JxlReadColorProfile, but profiles GamutAdapter can't handle are converted into sRGB
+ * by libjxl itself while rendering when the CMS is attached, then no ICC is returned.
+ * Falls back to JxlReadColorProfile and the lcms pass when libjxl refuses the conversion.
+ */
+bool JxlResolveColorProfile(JxlDecoder *dec, bool cmsAttached, bool grayscale,
+                            std::vector<uint8_t> *iccProfile,
+                            bool *preferEncoding, JxlColorEncoding *colorEncoding);
 
 bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                          std::vector<uint8_t> *pixels, size_t *xsize,
@@ -42,4 +96,141 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                          JxlColorEncoding *colorEncoding,
                          bool *hasAlphaInOrigin);
 
+/**
+ * Same as DecodeJpegXlOneShot, but when the planner accepts a target the pixels are resampled
+ * row by row straight from the libjxl image out callback, so the full resolution frame
+ * is never allocated. *sampled reports if this happened, then xsize and ysize hold the target size.
+ * When components is not null pixels keep the image own layout, gray, gray + alpha, RGB or RGBA,
+ * and components receives its channels count, otherwise pixels are always RGBA.
+ * When float32 is not null high bit depth pixels are 32 bit floats instead of half floats,
+ * float32 reports which one was used.
+ */
+bool DecodeJpegXlSampled(const uint8_t *jxl, size_t size,
+                         std::vector<uint8_t> *pixels, size_t *xsize,
+                         size_t *ysize, std::vector<uint8_t> *iccProfile,
+                         bool *useFloats, int *bitDepth,
+                         bool *alphaPremultiplied, bool allowedFloats,
+                         JxlOrientation *jxlOrientation,
+                         bool *preferEncoding,
+                         JxlColorEncoding *colorEncoding,
+                         bool *hasAlphaInOrigin,
+                         const JxlSamplePlanner &planner,
+                         bool *sampled,
+                         int *components = nullptr,
+                         bool *float32 = nullptr);
+
+/**
+ * Region of interest in oriented image coordinates, scaled by scale in (0, 1].
+ */
+struct JxlRegion {
+  int x;
+  int y;
+  int width;
+  int height;
+  float scale;
+};
+
+/**
+ * Decodes only the region of interest, rows and columns outside of it are dropped
+ * in the image out callback. Region is clamped to the image bounds,
+ * decoding fails when nothing of it is left.
+ */
+bool DecodeJpegXlRegion(const uint8_t *jxl, size_t size,
+                        std::vector<uint8_t> *pixels, size_t *xsize,
+                        size_t *ysize, std::vector<uint8_t> *iccProfile,
+                        bool *useFloats, int *bitDepth,
+                        bool *alphaPremultiplied, bool allowedFloats,
+                        JxlOrientation *jxlOrientation,
+                        bool *preferEncoding,
+                        JxlColorEncoding *colorEncoding,
+                        bool *hasAlphaInOrigin,
+                        const JxlRegion &region,
+                        XSampler sampler,
+                        int *components = nullptr,
+                        bool *float32 = nullptr);
+
+/**
+ * Caller owned destination, rows are stride bytes apart.
+ */
+struct JxlDecodeTarget {
+  uint8_t *data;
+  size_t stride;
+};
+
+/**
+ * Asked once the output size and sample type are known, colour profile is already read by then.
+ * xsize and ysize are the displayed size, with the orientation already applied.
+ * Returns false to let the decoder keep pixels in its own buffer,
+ * returning true without filling target data fails the decoding.
+ */
+typedef std::function<bool(size_t xsize, size_t ysize, bool useFloats, JxlDecodeTarget *target)> JxlTargetProvider;
+
+/**
+ * Decoder and worker pool kept alive between images, so decoding a sequence of them
+ * doesn't create threads and decoder state for each one.
+ */
+struct JxlDecoderSession {
+  JxlDecoderPtr decoder;
+  JxlResizableParallelRunnerPtr runner;
+};
+
+bool JxlCreateDecoderSession(JxlDecoderSession *session);
+
+/**
+ * Decodes straight into the destination handed out by the provider, libjxl or the streaming resampler
+ * write with the destination stride so no intermediate frame is allocated.
+ * direct->data is non null when the provider destination was used, otherwise pixels hold the image.
+ * Provided destinations are always RGBA in half floats for high bit depth,
+ * pixels follow the components and float32 rules of DecodeJpegXlSampled.
+ * When session is not null its decoder is reset and reused with its worker pool.
+ */
+bool DecodeJpegXlInto(const uint8_t *jxl, size_t size,
+                      std::vector<uint8_t> *pixels, size_t *xsize,
+                      size_t *ysize, std::vector<uint8_t> *iccProfile,
+                      bool *useFloats, int *bitDepth,
+                      bool *alphaPremultiplied, bool allowedFloats,
+                      JxlOrientation *jxlOrientation,
+                      bool *preferEncoding,
+                      JxlColorEncoding *colorEncoding,
+                      bool *hasAlphaInOrigin,
+                      const JxlSamplePlanner &planner,
+                      bool *sampled,
+                      const JxlTargetProvider &provider,
+                      JxlDecodeTarget *direct,
+                      int *components = nullptr,
+                      bool *float32 = nullptr,
+                      JxlDecoderSession *session = nullptr);
+
+/**
+ * Image metadata that is available without decoding pixels.
+ * Width and height are in display orientation, orientation is the one stored in the codestream.
+ */
+struct JxlImageProbe {
+  uint32_t width;
+  uint32_t height;
+  JxlOrientation orientation;
+  uint32_t bitsPerSample;
+  uint32_t exponentBitsPerSample;
+  bool hasAlpha;
+  bool alphaPremultiplied;
+  bool animated;
+  int numberOfFrames;
+  int loopsCount;
+  bool hasColorEncoding;
+  JxlColorEncoding colorEncoding;
+  size_t iccSize;
+};
+
+/**
+ * Reads up to size bytes of the file starting at offset into dst, returns amount of bytes read.
+ */
+typedef std::function<size_t(size_t offset, size_t size, uint8_t *dst)> JxlInputReader;
+
+/**
+ * Reads only the headers: starts with JxlDecoderSizeHintBasicInfo bytes and asks the reader for more
+ * only when libjxl needs them, no thread pool and no pixel buffers are created.
+ * Frames are counted only for animations and when countFrames is set, that walks frame headers of the whole file.
+ */
+bool ProbeJpegXl(const JxlInputReader &reader, size_t totalSize, bool countFrames, JxlImageProbe *probe);
+
 bool DecodeBasicInfo(const uint8_t *jxl, size_t size, size_t *xsize, size_t *ysize);
@@ -0,0 +1,206 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 03/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JxlStreamingDecoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include "JxlDecoding.h"
+
+JxlStreamingDecoder::JxlStreamingDecoder(bool allowedFloats, bool progressive, JxlProgressiveDetail detail) :
+    allowedFloats(allowedFloats) {
+  runner = JxlResizableParallelRunnerMake(nullptr);
+  dec = JxlDecoderMake(nullptr);
+  if (!dec) {
+    std::string str = "Cannot create decoder";
+    throw StreamingDecoderError(str);
+  }
+  int events = JXL_DEC_BASIC_INFO | JXL_DEC_COLOR_ENCODING | JXL_DEC_FULL_IMAGE;
+  if (progressive) {
+    events |= JXL_DEC_FRAME_PROGRESSION;
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), events)) {
+    std::string str = "Cannot subscribe to decoder events";
+    throw StreamingDecoderError(str);
+  }
+  if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(),
+                                                     JxlResizableParallelRunner,
+                                                     runner.get())) {
+    std::string str = "Cannot attach parallel runner to decoder";
+    throw StreamingDecoderError(str);
+  }
+  cmsAttached = JxlAttachCms(dec.get());
+  if (progressive && JXL_DEC_SUCCESS != JxlDecoderSetProgressiveDetail(dec.get(), detail)) {
+    std::string str = "Cannot set progressive detail";
+    throw StreamingDecoderError(str);
+  }
+}
+
+void *JxlStreamingDecoder::outInit(void *initOpaque, size_t /* numThreads */, size_t /* numPixelsPerThread */) {
+  return initOpaque;
+}
+
+void JxlStreamingDecoder::outRun(void *runOpaque, size_t threadId,
+                                 size_t x, size_t y, size_t numPixels, const void *data) {
+  auto decoder = reinterpret_cast<JxlStreamingDecoder *>(runOpaque);
+  std::memcpy(decoder->pixels.data() + y * decoder->stride + x * decoder->pixelSize,
+              data, numPixels * decoder->pixelSize);
+  decoder->decodedPixels.fetch_add(numPixels, std::memory_order_relaxed);
+}
+
+void JxlStreamingDecoder::outDestroy(void * /* runOpaque */) {
+}
+
+void JxlStreamingDecoder::compactInput() {
+  // libjxl keeps pointing into the buffer, so it must be released before the buffer changes
+  size_t remaining = JxlDecoderReleaseInput(dec.get());
+  bytesConsumed += input.size() - remaining;
+  input.erase(input.begin(), input.end() - static_cast<std::ptrdiff_t>(remaining));
+  inputAttached = false;
+}
+
+void JxlStreamingDecoder::append(const uint8_t *data, size_t size) {
+  if (inputClosed) {
+    std::string str = "Input is already closed";
+    throw StreamingDecoderError(str);
+  }
+  if (inputAttached) {
+    compactInput();
+  }
+  input.insert(input.end(), data, data + size);
+  bytesReceived += size;
+  if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), input.data(), input.size())) {
+    std::string str = "Set input has failed";
+    throw StreamingDecoderError(str);
+  }
+  inputAttached = true;
+}
+
+void JxlStreamingDecoder::closeInput() {
+  if (!inputClosed) {
+    JxlDecoderCloseInput(dec.get());
+    inputClosed = true;
+  }
+}
+
+bool JxlStreamingDecoder::flush() {
+  std::lock_guard guard(lock);
+  if (JXL_DEC_SUCCESS != JxlDecoderFlushImage(dec.get())) {
+    // Not fatal, there is just not enough data to render yet
+    return false;
+  }
+  // Flushed pixels are rendered once more by the following pass
+  decodedPixels = 0;
+  passes += 1;
+  return true;
+}
+
+JxlStreamingProgress JxlStreamingDecoder::getProgress() {
+  JxlStreamingProgress progress;
+  progress.bytesReceived = bytesReceived;
+  progress.bytesConsumed = bytesConsumed;
+  progress.totalPixels = basicInfoReceived ? static_cast<size_t>(orientedWidth) * orientedHeight : 0;
+  progress.decodedPixels = complete ? progress.totalPixels
+                                    : std::min(decodedPixels.load(), progress.totalPixels);
+  progress.passes = passes;
+  progress.hasBasicInfo = basicInfoReceived;
+  progress.complete = complete;
+  return progress;
+}
+
+JxlStreamingStatus JxlStreamingDecoder::process() {
+  if (complete) {
+    return StreamingComplete;
+  }
+  if (!inputAttached) {
+    return inputClosed ? StreamingError : StreamingNeedMoreInput;
+  }
+  for (;;) {
+    JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+    if (status == JXL_DEC_ERROR) {
+      return StreamingError;
+    } else if (status == JXL_DEC_NEED_MORE_INPUT) {
+      if (inputClosed) {
+        return StreamingError;
+      }
+      compactInput();
+      if (!input.empty()) {
+        if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), input.data(), input.size())) {
+          return StreamingError;
+        }
+        inputAttached = true;
+      }
+      return StreamingNeedMoreInput;
+    } else if (status == JXL_DEC_BASIC_INFO) {
+      if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec.get(), &info)) {
+        return StreamingError;
+      }
+      useFloats = info.bits_per_sample > 8 && allowedFloats;
+      format = {4, useFloats ? JXL_TYPE_FLOAT16 : JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+      pixelSize = 4 * (useFloats ? sizeof(uint16_t) : sizeof(uint8_t));
+      // Image out callbacks address pixels of the oriented image
+      const bool transposed = info.orientation > JXL_ORIENT_ROTATE_180;
+      orientedWidth = transposed ? info.ysize : info.xsize;
+      orientedHeight = transposed ? info.xsize : info.ysize;
+      stride = orientedWidth * pixelSize;
+      basicInfoReceived = true;
+      JxlResizableParallelRunnerSetThreads(
+          runner.get(),
+          JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
+    } else if (status == JXL_DEC_COLOR_ENCODING) {
+      if (!JxlResolveColorProfile(dec.get(), cmsAttached, info.num_color_channels == 1,
+                                  &iccProfile, &preferEncoding, &colorEncoding)) {
+        return StreamingError;
+      }
+    } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+      std::lock_guard guard(lock);
+      pixels.resize(stride * orientedHeight);
+      decodedPixels = 0;
+      // Callback instead of out buffer lets count delivered pixels for progress
+      if (JXL_DEC_SUCCESS != JxlDecoderSetMultithreadedImageOutCallback(dec.get(), &format,
+                                                                        outInit, outRun, outDestroy,
+                                                                        this)) {
+        return StreamingError;
+      }
+    } else if (status == JXL_DEC_FRAME_PROGRESSION) {
+      downsamplingRatio = static_cast<int>(JxlDecoderGetIntendedDownsamplingRatio(dec.get()));
+      if (flush()) {
+        return StreamingPass;
+      }
+    } else if (status == JXL_DEC_FULL_IMAGE) {
+      // Only the first frame is shown, animations are served by JxlAnimatedDecoder
+      complete = true;
+      passes += 1;
+      return StreamingComplete;
+    } else if (status == JXL_DEC_SUCCESS) {
+      complete = true;
+      return StreamingComplete;
+    } else {
+      return StreamingError;
+    }
+  }
+}
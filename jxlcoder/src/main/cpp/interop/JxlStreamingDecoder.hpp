@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 03/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "decode.h"
+#include "decode_cxx.h"
+#include "resizable_parallel_runner.h"
+#include "resizable_parallel_runner_cxx.h"
+
+class StreamingDecoderError : public std::exception {
+ public:
+  StreamingDecoderError(const std::string &message) : errorMessage(message) {}
+
+  const char *what() const noexcept override {
+    return errorMessage.c_str();
+  }
+
+ private:
+  std::string errorMessage;
+};
+
+enum JxlStreamingStatus {
+  StreamingNeedMoreInput = 1,
+  StreamingPass = 2,
+  StreamingComplete = 3,
+  StreamingError = 4
+};
+
+struct JxlStreamingProgress {
+  size_t bytesReceived;
+  size_t bytesConsumed;
+  size_t decodedPixels;
+  size_t totalPixels;
+  int passes;
+  bool hasBasicInfo;
+  bool complete;
+};
+
+/**
+ * Decoder that is fed with input chunks as they arrive and keeps libjxl state between them,
+ * so reading and decoding overlap instead of buffering the whole file first.
+ * In progressive mode every JXL_DEC_FRAME_PROGRESSION is flushed into the output, so the first pass
+ * is the 1:8 DC image and each following pass refines it until the full image is decoded.
+ */
+class JxlStreamingDecoder {
+ public:
+  JxlStreamingDecoder(bool allowedFloats, bool progressive, JxlProgressiveDetail detail = kPasses);
+
+  void append(const uint8_t *data, size_t size);
+
+  void closeInput();
+
+  /**
+   * Runs the decoder over the input received so far and stops at the next event worth reporting:
+   * a flushed pass, the completed image, or the end of available input.
+   */
+  JxlStreamingStatus process();
+
+  JxlStreamingProgress getProgress();
+
+  std::vector<uint8_t> getPixels() {
+    std::lock_guard guard(lock);
+    return pixels;
+  }
+
+  bool hasPixels() {
+    return passes > 0 || complete;
+  }
+
+  /**
+   * Downsampling ratio the current pixels were rendered with, 1 once the image is complete.
+   */
+  int getDownsamplingRatio() {
+    return complete ? 1 : downsamplingRatio;
+  }
+
+  bool isComplete() {
+    return complete;
+  }
+
+  /**
+   * Size of the stored pixels, width and height are swapped for transposing orientations
+   */
+  uint32_t getWidth() {
+    return orientedWidth;
+  }
+
+  uint32_t getHeight() {
+    return orientedHeight;
+  }
+
+  bool hasBasicInfo() {
+    return basicInfoReceived;
+  }
+
+  bool isUseFloats() {
+    return useFloats;
+  }
+
+  int getBitDepth() {
+    return static_cast<int>(info.bits_per_sample);
+  }
+
+  bool isAlphaPremultiplied() {
+    return info.alpha_premultiplied;
+  }
+
+  bool isHasAlphaInOrigin() {
+    return info.num_extra_channels > 0 && info.alpha_bits > 0;
+  }
+
+  std::vector<uint8_t> &getIccProfile() {
+    return iccProfile;
+  }
+
+  bool isPreferEncoding() {
+    return preferEncoding;
+  }
+
+  JxlColorEncoding getColorEncoding() {
+    return colorEncoding;
+  }
+
+ private:
+  bool flush();
+
+  void compactInput();
+
+  static void *outInit(void *initOpaque, size_t numThreads, size_t numPixelsPerThread);
+
+  static void outRun(void *runOpaque, size_t threadId,
+                     size_t x, size_t y, size_t numPixels, const void *data);
+
+  static void outDestroy(void *runOpaque);
+
+  JxlDecoderPtr dec;
+  JxlResizableParallelRunnerPtr runner;
+  std::vector<uint8_t> input;
+  size_t bytesReceived = 0;
+  size_t bytesConsumed = 0;
+  bool inputAttached = false;
+  bool inputClosed = false;
+  bool allowedFloats;
+  bool useFloats = false;
+  bool basicInfoReceived = false;
+  bool complete = false;
+  int passes = 0;
+  int downsamplingRatio = 8;
+  std::atomic<size_t> decodedPixels = 0;
+  JxlBasicInfo info = {};
+  JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+  uint32_t orientedWidth = 0;
+  uint32_t orientedHeight = 0;
+  size_t pixelSize = 4;
+  size_t stride = 0;
+  std::vector<uint8_t> pixels;
+  std::vector<uint8_t> iccProfile;
+  bool preferEncoding = false;
+  JxlColorEncoding colorEncoding = {};
+  bool cmsAttached = false;
+  std::mutex lock;
+};
@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 02/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ResampleWeights.h"
+#include <algorithm>
+#include <cmath>
+#include "algo/sampler.h"
+
+namespace coder {
+
+float ResampleKernelRadius(XSampler sampler) {
+  switch (sampler) {
+    case nearest:
+    case area:return 0.5f;
+    case bilinear:return 1.f;
+    case lanczos:
+    case hann:return 3.f;
+    default:return 2.f;
+  }
+}
+
+float ResampleKernel(float x, XSampler sampler) {
+  switch (sampler) {
+    case bilinear: {
+      const float ax = std::abs(x);
+      return ax < 1.f ? 1.f - ax : 0.f;
+    }
+    case nearest:return std::abs(x) <= 0.5f ? 1.f : 0.f;
+    case cubic:return SimpleCubic(x);
+    case mitchell:return MitchellNetravalli(x);
+    case lanczos:return LanczosWindow(x, 3.f);
+    case catmullRom:return CatmullRom(x);
+    case hermite:return CubicHermite(x);
+    case bSpline:return BSpline(x);
+    case hann:return Hann(x, 3.f);
+    case bicubic:return BiCubicSpline(x);
+    case area:return std::abs(x) <= 0.5f ? 1.f : 0.f;
+  }
+  return 0.f;
+}
+
+ResampleWeights BuildResampleWeights(int srcSize, int scaledSize, XSampler sampler,
+                                     int dstOffset, int dstCount) {
+  const bool antialias = scaledSize < srcSize;
+  if (dstCount < 0) {
+    dstCount = scaledSize - dstOffset;
+  }
+
+  ResampleWeights table;
+  table.srcSize = srcSize;
+  table.dstSize = dstCount;
+
+  const float scale = static_cast<float>(srcSize) / static_cast<float>(scaledSize);
+  const float filterScale = antialias ? std::max(scale, 1.f) : 1.f;
+  const float radius = ResampleKernelRadius(sampler) * filterScale;
+
+  if (sampler == nearest) {
+    table.taps = 1;
+  } else if (antialias) {
+    table.taps = static_cast<int>(std::ceil(radius * 2.f)) + 1;
+  } else {
+    table.taps = static_cast<int>(std::ceil(radius)) * 2;
+  }
+  table.taps = std::max(std::min(table.taps, srcSize), 1);
+
+  table.start.resize(dstCount);
+  table.weights.resize(static_cast<size_t>(dstCount) * table.taps, 0.f);
+
+  for (int i = 0; i < dstCount; ++i) {
+    const int x = i + dstOffset;
+    float *weights = table.weights.data() + static_cast<size_t>(i) * table.taps;
+
+    if (sampler == nearest) {
+      const float center = antialias ? (static_cast<float>(x) + 0.5f) * scale
+                                     : static_cast<float>(x) * scale;
+      table.start[i] = std::clamp(static_cast<int>(center), 0, srcSize - 1);
+      weights[0] = 1.f;
+      continue;
+    }
+
+    // Legacy alignment keeps XScaler results: samples are taken at x * scale and
+    // kernels are evaluated on integer neighbours of floor(x * scale)
+    float center;
+    int first, last;
+    if (antialias) {
+      center = (static_cast<float>(x) + 0.5f) * scale - 0.5f;
+      first = static_cast<int>(std::ceil(center - radius));
+      last = static_cast<int>(std::floor(center + radius));
+    } else {
+      center = static_cast<float>(x) * scale;
+      const int iRadius = static_cast<int>(std::ceil(radius));
+      first = static_cast<int>(std::floor(center)) - iRadius + 1;
+      last = static_cast<int>(std::floor(center)) + iRadius;
+    }
+
+    const int windowStart = std::clamp(std::clamp(first, 0, srcSize - 1), 0,
+                                       srcSize - table.taps);
+    table.start[i] = windowStart;
+
+    float weightSum = 0.f;
+    for (int j = first; j <= last; ++j) {
+      float weight;
+      if (sampler == hann && !antialias) {
+        weight = Hann(static_cast<float>(j) - std::floor(center), 3.f);
+      } else {
+        weight = ResampleKernel((static_cast<float>(j) - center) / filterScale, sampler);
+      }
+      const int position = std::clamp(j, 0, srcSize - 1) - windowStart;
+      if (position < 0 || position >= table.taps) {
+        continue;
+      }
+      weights[position] += weight;
+      weightSum += weight;
+    }
+
+    if (std::abs(weightSum) > 1e-6f) {
+      const float normalize = 1.f / weightSum;
+      for (int j = 0; j < table.taps; ++j) {
+        weights[j] *= normalize;
+      }
+    }
+  }
+
+  return table;
+}
+
+ResampleWeightsQ14 QuantizeResampleWeights(const ResampleWeights &table) {
+  ResampleWeightsQ14 fixed;
+  fixed.srcSize = table.srcSize;
+  fixed.dstSize = table.dstSize;
+  fixed.taps = table.taps;
+  fixed.start = table.start;
+  fixed.weights.resize(table.weights.size());
+
+  constexpr int one = 1 << kResampleWeightsBits;
+  for (int i = 0; i < table.dstSize; ++i) {
+    const float *weights = table.weights.data() + static_cast<size_t>(i) * table.taps;
+    int16_t *quantized = fixed.weights.data() + static_cast<size_t>(i) * table.taps;
+    int sum = 0;
+    int largest = 0;
+    for (int j = 0; j < table.taps; ++j) {
+      quantized[j] = static_cast<int16_t>(std::lround(weights[j] * static_cast<float>(one)));
+      sum += quantized[j];
+      if (std::abs(weights[j]) > std::abs(weights[largest])) {
+        largest = j;
+      }
+    }
+    // Rounding error goes to the dominant tap so flat areas stay exactly flat
+    quantized[largest] = static_cast<int16_t>(quantized[largest] + one - sum);
+  }
+  return fixed;
+}
+}
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 02/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "XScaler.h"
+
+namespace coder {
+
+/**
+ * One axis of a separable resize. Destination sample `i` reads `taps` consecutive
+ * source samples beginning at `start[i]` with weights `weights[i * taps + k]`.
+ * Windows are kept inside the source, taps that fall outside are folded onto the edge,
+ * so sampling never needs clamping.
+ */
+struct ResampleWeights {
+  int srcSize = 0;
+  int dstSize = 0;
+  int taps = 0;
+  std::vector<int> start;
+  std::vector<float> weights;
+};
+
+float ResampleKernelRadius(XSampler sampler);
+
+float ResampleKernel(float x, XSampler sampler);
+
+/**
+ * Every resampler takes its tables from here, so one resize is aligned the same whichever path runs it.
+ * Reduced axes sample at pixel centres and stretch the kernel support by the downscale factor,
+ * enlarged and kept axes sample at x * scale with the kernel as is.
+ * @param scaledSize full size of the scaled axis, defines the scale factor
+ * @param dstOffset first destination sample that will be produced
+ * @param dstCount amount of destination samples that will be produced, -1 for all
+ */
+ResampleWeights BuildResampleWeights(int srcSize, int scaledSize, XSampler sampler,
+                                     int dstOffset = 0, int dstCount = -1);
+
+constexpr int kResampleWeightsBits = 14;
+
+/**
+ * Same table with weights in fixed point, every window sums exactly to 1 << kResampleWeightsBits.
+ */
+struct ResampleWeightsQ14 {
+  int srcSize = 0;
+  int dstSize = 0;
+  int taps = 0;
+  std::vector<int> start;
+  std::vector<int16_t> weights;
+};
+
+ResampleWeightsQ14 QuantizeResampleWeights(const ResampleWeights &table);
+}
@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "ResizePlan.h"
+
+namespace coder {
+
+bool ResizePlanKey::operator==(const ResizePlanKey &other) const {
+  return inputWidth == other.inputWidth && inputHeight == other.inputHeight
+      && outputWidth == other.outputWidth && outputHeight == other.outputHeight
+      && windowX == other.windowX && windowY == other.windowY
+      && windowWidth == other.windowWidth && windowHeight == other.windowHeight
+      && sampler == other.sampler && fixedPoint == other.fixedPoint;
+}
+
+std::shared_ptr<const ResizePlan> BuildResizePlan(const ResizePlanKey &key) {
+  auto plan = std::make_shared<ResizePlan>();
+  plan->key = key;
+  plan->horizontal = BuildResampleWeights(key.inputWidth, key.outputWidth, key.sampler,
+                                          key.windowX, key.windowWidth);
+  plan->vertical = BuildResampleWeights(key.inputHeight, key.outputHeight, key.sampler,
+                                        key.windowY, key.windowHeight);
+  // Horizontal rows are padded for the widest vector the running target filters them with
+  const int lanes = key.sampler != nearest ? HorizontalFilterLanes() : kMinPaddedLanes;
+  if (key.sampler != nearest) {
+    plan->paddedHorizontal = PadWeights<float>(plan->horizontal, lanes);
+  }
+  if (key.sampler != nearest && key.fixedPoint) {
+    plan->horizontalQ14 = QuantizeResampleWeights(plan->horizontal);
+    plan->verticalQ14 = QuantizeResampleWeights(plan->vertical);
+    plan->paddedHorizontalQ14 = PadWeights<int32_t>(plan->horizontalQ14, lanes);
+  }
+  return plan;
+}
+
+std::shared_ptr<const ResizePlan> ResizePlanCache::get(const ResizePlanKey &key) {
+  std::lock_guard guard(mutex);
+  if (!plan || !(plan->key == key)) {
+    plan = BuildResizePlan(key);
+  }
+  return plan;
+}
+}
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ResampleWeights.h"
+#include "XScaler.h"
+
+namespace coder {
+
+// Padded weight rows are read with vectors of 4, 8 or 16 lanes
+constexpr int kMinPaddedLanes = 4;
+constexpr int kMaxPaddedLanes = 16;
+
+/**
+ * Weight table whose rows are padded with zero weights to a multiple of lanes, so one
+ * destination sample reads its source window and its weights as whole vectors of that width
+ */
+template<typename T>
+struct PaddedWeights {
+  int dstSize = 0;
+  int taps = 0;
+  int lanes = kMinPaddedLanes;
+  std::vector<int> start;
+  std::vector<T> weights;
+};
+
+/**
+ * Lanes are the smallest vector width that covers a window, at most maxLanes
+ */
+template<typename T, class Table>
+PaddedWeights<T> PadWeights(const Table &table, const int maxLanes) {
+  PaddedWeights<T> padded;
+  padded.dstSize = table.dstSize;
+  while (padded.lanes < maxLanes && padded.lanes < table.taps) {
+    padded.lanes *= 2;
+  }
+  padded.taps = (table.taps + padded.lanes - 1) / padded.lanes * padded.lanes;
+  padded.start = table.start;
+  padded.weights.assign(static_cast<size_t>(padded.dstSize) * padded.taps, T(0));
+  for (int x = 0; x < table.dstSize; ++x) {
+    for (int k = 0; k < table.taps; ++k) {
+      padded.weights[static_cast<size_t>(x) * padded.taps + k] =
+          static_cast<T>(table.weights[static_cast<size_t>(x) * table.taps + k]);
+    }
+  }
+  return padded;
+}
+
+/**
+ * Source size, scaled size, produced window and filter of a resize. fixedPoint asks for the
+ * Q14 tables as well, only 8 bit pixels are filtered with them.
+ */
+struct ResizePlanKey {
+  int inputWidth = 0;
+  int inputHeight = 0;
+  int outputWidth = 0;
+  int outputHeight = 0;
+  int windowX = 0;
+  int windowY = 0;
+  int windowWidth = 0;
+  int windowHeight = 0;
+  XSampler sampler = bilinear;
+  bool fixedPoint = false;
+
+  bool operator==(const ResizePlanKey &other) const;
+};
+
+/**
+ * Everything a resize needs before touching pixels: weight tables of both axes in float and,
+ * when the key asks for it, in fixed point, and horizontal weights padded for the vector filters.
+ */
+struct ResizePlan {
+  ResizePlanKey key;
+  ResampleWeights horizontal;
+  ResampleWeights vertical;
+  PaddedWeights<float> paddedHorizontal;
+  ResampleWeightsQ14 horizontalQ14;
+  ResampleWeightsQ14 verticalQ14;
+  PaddedWeights<int32_t> paddedHorizontalQ14;
+};
+
+std::shared_ptr<const ResizePlan> BuildResizePlan(const ResizePlanKey &key);
+
+/**
+ * Keeps the last plan, so repeated resizes with the same key, like every frame of an animation,
+ * go straight to kernel application.
+ */
+class ResizePlanCache {
+ public:
+  std::shared_ptr<const ResizePlan> get(const ResizePlanKey &key);
+
+ private:
+  std::mutex mutex;
+  std::shared_ptr<const ResizePlan> plan;
+};
+}
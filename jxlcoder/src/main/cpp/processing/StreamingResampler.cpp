@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 02/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "StreamingResampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include "conversion/HalfFloats.h"
+#include "TransferLut.h"
+
+namespace coder {
+
+static const int kGroupDim = 256;
+
+static size_t StreamingSampleSize(StreamingSample sample) {
+  switch (sample) {
+    case streamingU8:return sizeof(uint8_t);
+    case streamingF16:return sizeof(uint16_t);
+    default:return sizeof(float);
+  }
+}
+
+StreamingResampler::StreamingResampler(int srcX, int srcY, int srcWidth, int srcHeight,
+                                       int scaledWidth, int scaledHeight,
+                                       int dstX, int dstY, int dstWidth, int dstHeight,
+                                       int components, XSampler sampler, bool linearLight,
+                                       XAlphaMode alphaMode, StreamingSample input)
+    : srcX(srcX), srcY(srcY), srcWidth(srcWidth), srcHeight(srcHeight),
+      dstWidth(dstWidth), dstHeight(dstHeight), components(components), linearLight(linearLight),
+      alphaMode(TransferChannels(components) < components ? alphaMode : alphaAsIs),
+      input(input), inputSampleSize(StreamingSampleSize(input)),
+      horizontal(BuildResampleWeights(srcWidth, scaledWidth, sampler, dstX, dstWidth)),
+      vertical(BuildResampleWeights(srcHeight, scaledHeight, sampler, dstY, dstHeight)),
+      received(srcHeight, 0), sources(srcHeight), filtered(srcHeight), users(srcHeight, 0),
+      missingRows(dstHeight, vertical.taps) {
+  for (int k = 0; k < dstHeight; ++k) {
+    for (int t = 0; t < vertical.taps; ++t) {
+      users[vertical.start[k] + t] += 1;
+    }
+  }
+}
+
+size_t StreamingResampler::EstimateFootprint(int srcWidth, int srcHeight, int scaledHeight, int dstWidth,
+                                             int components, size_t sampleSize, XSampler sampler,
+                                             size_t threads) {
+  const size_t groupsPerRow = (static_cast<size_t>(srcWidth) + kGroupDim - 1) / kGroupDim;
+  const size_t groupRows = (std::max(threads, static_cast<size_t>(1)) + groupsPerRow - 1) / groupsPerRow + 1;
+  const float scale = std::max(static_cast<float>(srcHeight) / static_cast<float>(scaledHeight), 1.f);
+  const auto support = static_cast<size_t>(std::ceil(ResampleKernelRadius(sampler) * 2.f * scale)) + 1;
+  const size_t sourceRows = std::min(static_cast<size_t>(srcHeight), groupRows * kGroupDim);
+  const size_t filteredRows = std::min(static_cast<size_t>(srcHeight), sourceRows + support);
+  return sourceRows * srcWidth * components * sampleSize
+      + filteredRows * dstWidth * components * sizeof(float);
+}
+
+void StreamingResampler::setOutput(uint8_t *dst, size_t dstStride, StreamingSample sample) {
+  output = dst;
+  outputStride = dstStride;
+  outputSample = sample;
+}
+
+void StreamingResampler::prepare(size_t threads) {
+  scratch.resize(std::max(threads, static_cast<size_t>(1)));
+  for (auto &row: scratch) {
+    row.resize(static_cast<size_t>(srcWidth) * components);
+  }
+  // Vertical sum and its finished copy
+  rowScratch.resize(scratch.size());
+  for (auto &row: rowScratch) {
+    row.resize(static_cast<size_t>(dstWidth) * components * 2);
+  }
+}
+
+void StreamingResampler::pushRow(size_t threadId, int x, int y, int count, const void *pixels) {
+  y -= srcY;
+  if (y < 0 || y >= srcHeight) {
+    return;
+  }
+  const int visibleFrom = std::max(x, srcX);
+  const int visibleTo = std::min(x + count, srcX + srcWidth);
+  if (visibleFrom >= visibleTo) {
+    return;
+  }
+
+  const int *vStart = vertical.start.data();
+  const int vTaps = vertical.taps;
+  const int kFirst = static_cast<int>(std::partition_point(vStart, vStart + dstHeight,
+                                                           [&](int s) { return s + vTaps <= y; }) - vStart);
+  const int kEnd = static_cast<int>(std::partition_point(vStart + kFirst, vStart + dstHeight,
+                                                         [&](int s) { return s <= y; }) - vStart);
+  if (kFirst >= kEnd) {
+    return;
+  }
+
+  const size_t pixelSize = components * inputSampleSize;
+  uint8_t *row;
+  {
+    std::lock_guard guard(lock);
+    auto &source = sources[y];
+    if (source.empty()) {
+      if (!freeSources.empty()) {
+        source = std::move(freeSources.back());
+        freeSources.pop_back();
+      } else {
+        source.resize(static_cast<size_t>(srcWidth) * pixelSize);
+      }
+    }
+    row = source.data();
+  }
+  // Fragments never overlap, so they are copied outside the lock
+  std::memcpy(row + (visibleFrom - srcX) * pixelSize,
+              reinterpret_cast<const uint8_t *>(pixels) + (visibleFrom - x) * pixelSize,
+              (visibleTo - visibleFrom) * pixelSize);
+
+  std::vector<float> resampled;
+  {
+    std::lock_guard guard(lock);
+    received[y] += visibleTo - visibleFrom;
+    if (received[y] < srcWidth) {
+      return;
+    }
+    if (!freeFiltered.empty()) {
+      resampled = std::move(freeFiltered.back());
+      freeFiltered.pop_back();
+    }
+  }
+
+  // The last fragment of a row resamples it, every other thread already left it
+  resampled.resize(static_cast<size_t>(dstWidth) * components);
+  filterRow(threadId, row, resampled.data());
+
+  std::vector<int> ready;
+  {
+    std::lock_guard guard(lock);
+    freeSources.push_back(std::exchange(sources[y], {}));
+    filtered[y] = std::move(resampled);
+    for (int k = kFirst; k < kEnd; ++k) {
+      if (--missingRows[k] == 0) {
+        ready.push_back(k);
+      }
+    }
+  }
+
+  for (int k: ready) {
+    emitRow(threadId, k);
+  }
+}
+
+bool StreamingResampler::isComplete() {
+  std::lock_guard guard(lock);
+  return emittedRows == dstHeight;
+}
+
+void StreamingResampler::filterRow(size_t threadId, const uint8_t *src, float *dst) {
+  const int channels = components;
+  const int rowLength = srcWidth * channels;
+  float *pixels = scratch[threadId].data();
+
+  switch (input) {
+    case streamingU8:
+      for (int n = 0; n < rowLength; ++n) {
+        pixels[n] = static_cast<float>(src[n]) / 255.f;
+      }
+      break;
+    case streamingF16: {
+      auto halfs = reinterpret_cast<const uint16_t *>(src);
+      for (int n = 0; n < rowLength; ++n) {
+        pixels[n] = half_to_float(halfs[n]);
+      }
+    }
+      break;
+    case streamingF32:std::memcpy(pixels, src, rowLength * sizeof(float));
+      break;
+  }
+
+  if (linearLight || alphaMode != alphaAsIs) {
+    // Prepared once per source sample instead of once per tap
+    const TransferLut &lut = SRGBToLinearLut();
+    const int colorChannels = TransferChannels(channels);
+    const bool premultiply = alphaMode != alphaAsIs;
+    for (int i = 0; i < srcWidth; ++i) {
+      float *pixel = pixels + i * channels;
+      const float alpha = premultiply ? pixel[colorChannels] : 1.f;
+      for (int c = 0; c < colorChannels; ++c) {
+        pixel[c] = (linearLight ? lut.apply(pixel[c]) : pixel[c]) * alpha;
+      }
+    }
+  }
+
+  const int *hStart = horizontal.start.data();
+  const int hTaps = horizontal.taps;
+  for (int j = 0; j < dstWidth; ++j) {
+    const float *weights = horizontal.weights.data() + static_cast<size_t>(j) * hTaps;
+    const float *window = pixels + hStart[j] * channels;
+    float *out = dst + j * channels;
+    std::fill(out, out + channels, 0.f);
+    for (int t = 0; t < hTaps; ++t) {
+      const float weight = weights[t];
+      const float *sample = window + t * channels;
+      for (int c = 0; c < channels; ++c) {
+        out[c] += sample[c] * weight;
+      }
+    }
+  }
+}
+
+void StreamingResampler::emitRow(size_t threadId, int k) {
+  const int rowLength = dstWidth * components;
+  const int vTaps = vertical.taps;
+  const int start = vertical.start[k];
+  const float *weights = vertical.weights.data() + static_cast<size_t>(k) * vTaps;
+  float *sum = rowScratch[threadId].data();
+
+  // Taps are summed in window order whatever order their rows arrived in
+  std::fill(sum, sum + rowLength, 0.f);
+  for (int t = 0; t < vTaps; ++t) {
+    const float weight = weights[t];
+    if (weight == 0.f) {
+      continue;
+    }
+    const float *src = filtered[start + t].data();
+    for (int n = 0; n < rowLength; ++n) {
+      sum[n] += src[n] * weight;
+    }
+  }
+
+  uint8_t *dstRow = output + static_cast<size_t>(k) * outputStride;
+  if (outputSample == streamingF32) {
+    finishRow(sum, reinterpret_cast<float *>(dstRow));
+  } else {
+    float *row = sum + rowLength;
+    finishRow(sum, row);
+    if (outputSample == streamingF16) {
+      auto halfs = reinterpret_cast<uint16_t *>(dstRow);
+      for (int n = 0; n < rowLength; ++n) {
+        halfs[n] = float_to_half(row[n]);
+      }
+    } else {
+      for (int n = 0; n < rowLength; ++n) {
+        dstRow[n] = static_cast<uint8_t>(std::clamp(std::round(row[n] * 255.f), 0.f, 255.f));
+      }
+    }
+  }
+
+  std::lock_guard guard(lock);
+  for (int t = 0; t < vTaps; ++t) {
+    if (--users[start + t] == 0) {
+      freeFiltered.push_back(std::exchange(filtered[start + t], {}));
+    }
+  }
+  emittedRows += 1;
+}
+
+void StreamingResampler::finishRow(const float *src, float *dst) const {
+  const int colorChannels = TransferChannels(components);
+  const bool premultiplied = alphaMode != alphaAsIs && colorChannels < components;
+  if (!linearLight && !premultiplied) {
+    std::copy(src, src + dstWidth * components, dst);
+    return;
+  }
+  const TransferLut &lut = LinearToSRGBLut();
+  for (int x = 0; x < dstWidth; ++x) {
+    const float *pixel = src + x * components;
+    float *out = dst + x * components;
+    const float alpha = premultiplied ? pixel[colorChannels] : 1.f;
+    const bool divide = premultiplied && (alphaMode == alphaStraight || linearLight);
+    for (int c = 0; c < colorChannels; ++c) {
+      float value = pixel[c];
+      if (divide) {
+        value = alpha > 0.f ? value / alpha : 0.f;
+      }
+      if (linearLight) {
+        value = lut.apply(value);
+      }
+      if (premultiplied && alphaMode == alphaPremultiplyOutput) {
+        value = std::min(divide ? value * alpha : value, alpha);
+      }
+      out[c] = value;
+    }
+    for (int c = colorChannels; c < components; ++c) {
+      out[c] = pixel[c];
+    }
+  }
+}
+}
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 02/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "XScaler.h"
+#include "ResampleWeights.h"
+
+namespace coder {
+
+enum StreamingSample {
+  streamingU8,
+  streamingF16,
+  streamingF32
+};
+
+/**
+ * Separable resampler that is fed by arbitrary scanline fragments in any order and
+ * from any thread, as libjxl image out callbacks deliver them.
+ * Fragments are gathered until their source row is complete, then the row is resampled
+ * horizontally and kept only while a destination row still needs it. A destination row is
+ * summed in tap order as soon as its whole vertical window arrived and is written straight
+ * to the output, so results do not depend on delivery order and only the rows in flight
+ * are kept in memory.
+ */
+class StreamingResampler {
+ public:
+  /**
+   * @param srcX first source column that is resampled, pixels left of it are dropped
+   * @param srcY first source row that is resampled, rows above it are dropped
+   * @param srcWidth width of the resampled source region
+   * @param srcHeight height of the resampled source region
+   * @param scaledWidth full width of the scaled region
+   * @param scaledHeight full height of the scaled region
+   * @param dstX first visible column of the scaled region
+   * @param dstY first visible row of the scaled region
+   * @param dstWidth visible width that will be produced
+   * @param dstHeight visible height that will be produced
+   * @param linearLight pushed rows are sRGB encoded and are filtered in linear light,
+   * stored rows are encoded back
+   * @param alphaMode straight alpha is premultiplied on push, see XAlphaMode
+   * @param input sample type of pushed rows
+   */
+  StreamingResampler(int srcX, int srcY, int srcWidth, int srcHeight,
+                     int scaledWidth, int scaledHeight,
+                     int dstX, int dstY, int dstWidth, int dstHeight,
+                     int components, XSampler sampler, bool linearLight = false,
+                     XAlphaMode alphaMode = alphaAsIs,
+                     StreamingSample input = streamingF32);
+
+  /**
+   * Bytes kept while streaming: partial source rows of the libjxl groups in flight and
+   * resampled rows waiting for the vertical kernel. Groups are 256 pixels wide and
+   * are handed to threads in raster order.
+   * @param sampleSize bytes of one pushed sample
+   */
+  static size_t EstimateFootprint(int srcWidth, int srcHeight, int scaledHeight, int dstWidth,
+                                  int components, size_t sampleSize, XSampler sampler,
+                                  size_t threads);
+
+  /**
+   * Destination of finished rows, must be set before the first row is pushed
+   */
+  void setOutput(uint8_t *dst, size_t dstStride, StreamingSample output);
+
+  void prepare(size_t threads);
+
+  void pushRow(size_t threadId, int x, int y, int count, const void *pixels);
+
+  // All destination rows were written
+  bool isComplete();
+
+  int getWidth() const {
+    return dstWidth;
+  }
+
+  int getHeight() const {
+    return dstHeight;
+  }
+
+  int getComponents() const {
+    return components;
+  }
+
+ private:
+  // Linearises, premultiplies and resamples one complete source row horizontally
+  void filterRow(size_t threadId, const uint8_t *src, float *dst);
+
+  // Sums the vertical window of one destination row and writes it to the output
+  void emitRow(size_t threadId, int k);
+
+  // Undoes premultiplication and linearisation of one summed row as requested
+  void finishRow(const float *src, float *dst) const;
+
+  const int srcX;
+  const int srcY;
+  const int srcWidth;
+  const int srcHeight;
+  const int dstWidth;
+  const int dstHeight;
+  const int components;
+  const bool linearLight;
+  const XAlphaMode alphaMode;
+  const StreamingSample input;
+  const size_t inputSampleSize;
+  ResampleWeights horizontal;
+  ResampleWeights vertical;
+
+  uint8_t *output = nullptr;
+  size_t outputStride = 0;
+  StreamingSample outputSample = streamingF32;
+
+  std::mutex lock;
+  // Per source row: pixels received, raw pixels until complete, resampled row while used
+  std::vector<int> received;
+  std::vector<std::vector<uint8_t>> sources;
+  std::vector<std::vector<float>> filtered;
+  // Destination rows that still read each source row
+  std::vector<int> users;
+  // Source rows each destination row still waits for
+  std::vector<int> missingRows;
+  int emittedRows = 0;
+  std::vector<std::vector<uint8_t>> freeSources;
+  std::vector<std::vector<float>> freeFiltered;
+
+  std::vector<std::vector<float>> scratch;
+  std::vector<std::vector<float>> rowScratch;
+};
+}
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "TransferLut.h"
+#include <algorithm>
+#include <cmath>
+
+namespace coder {
+
+static float SRGBEotf(const float v) {
+  const float magnitude = std::abs(v);
+  if (magnitude < 12.92f * 0.0030412825601275209f) {
+    return v / 12.92f;
+  }
+  return std::copysign(std::pow((magnitude + 0.0550107189475866f) / 1.0550107189475866f, 2.4f), v);
+}
+
+static float SRGBOetf(const float linear) {
+  const float magnitude = std::abs(linear);
+  if (magnitude < 0.0030412825601275209f) {
+    return linear * 12.92f;
+  }
+  return std::copysign(1.0550107189475866f * std::pow(magnitude, 1.0f / 2.4f) - 0.0550107189475866f, linear);
+}
+
+TransferLut BuildTransferLut(const std::function<float(float)> &curve, int size, bool squareSpaced) {
+  TransferLut lut;
+  lut.size = size;
+  lut.squareSpaced = squareSpaced;
+  lut.table.resize(size + 2);
+  for (int i = 0; i <= size; ++i) {
+    const float t = static_cast<float>(i) / static_cast<float>(size);
+    lut.table[i] = curve(squareSpaced ? t * t : t);
+  }
+  lut.table[size + 1] = lut.table[size];
+  return lut;
+}
+
+float TransferLut::apply(float v) const {
+  if (extended && (v < 0.f || v > 1.f)) {
+    return extended(v);
+  }
+  v = std::clamp(v, 0.f, 1.f);
+  if (squareSpaced) {
+    v = std::sqrt(v);
+  }
+  v *= static_cast<float>(size);
+  const int index = static_cast<int>(v);
+  const float fraction = v - static_cast<float>(index);
+  return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+static TransferLut BuildExtendedTransferLut(float (*curve)(float)) {
+  TransferLut lut = BuildTransferLut(curve);
+  lut.extended = curve;
+  return lut;
+}
+
+const TransferLut &SRGBToLinearLut() {
+  static const TransferLut lut = BuildExtendedTransferLut(SRGBEotf);
+  return lut;
+}
+
+const TransferLut &LinearToSRGBLut() {
+  static const TransferLut lut = BuildExtendedTransferLut(SRGBOetf);
+  return lut;
+}
+}
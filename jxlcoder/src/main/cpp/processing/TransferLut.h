@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace coder {
+
+// Transfer curves are sampled on this many segments and linearly interpolated in between
+constexpr int kTransferLutSize = 4096;
+
+/**
+ * Transfer curve tabulated on [0, 1] in size segments. Inputs outside that range go to extended
+ * when it is set and are clamped otherwise.
+ * The table holds size + 2 samples so interpolation at 1.0 never reads past the end.
+ * Square spaced tables sample the curve at (i / size)^2 and are indexed by the square root of
+ * the input, which puts most samples at the steep start of encoding curves.
+ */
+struct TransferLut {
+  std::vector<float> table;
+  int size = kTransferLutSize;
+  bool squareSpaced = false;
+  float (*extended)(float) = nullptr;
+
+  float apply(float v) const;
+};
+
+TransferLut BuildTransferLut(const std::function<float(float)> &curve,
+                             int size = kTransferLutSize, bool squareSpaced = false);
+
+/**
+ * sRGB EOTF and its inverse, built once per process. Out of range float samples, like extended
+ * range half floats, follow the exact curve mirrored around zero instead of being clamped.
+ */
+const TransferLut &SRGBToLinearLut();
+const TransferLut &LinearToSRGBLut();
+
+/**
+ * Channels that carry colour and go through transfer curves, alpha of gray alpha and RGBA stays as is.
+ */
+static inline int TransferChannels(const int components) {
+  return (components == 2 || components == 4) ? components - 1 : components;
+}
+}
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import android.graphics.Bitmap
+import android.os.Build
+import android.util.Size
+import androidx.annotation.Keep
+import java.io.Closeable
+
+/**
+ * Decodes many small images in a row, e.g. for list prefetch.
+ * Decoder, its worker threads and scratch buffers are kept between images and batches,
+ * so prefer keeping one instance alive instead of creating one per batch.
+ */
+@Keep
+open class JxlBatchDecoder : Closeable {
+
+    private var coordinator: Long = -1L
+    private val lock = Any()
+
+    @Keep
+    public constructor(
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        scaleMode: ScaleMode = ScaleMode.FIT,
+        jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.CATMULL_ROM,
+        toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+    ) {
+        if (Build.VERSION.SDK_INT >= 21) {
+            System.loadLibrary("jxlcoder")
+        }
+        coordinator = createBatchCoordinator(
+            preferredColorConfig.value,
+            scaleMode.value,
+            jxlResizeFilter.value,
+            toneMapper.value,
+        )
+    }
+
+    /**
+     * Decodes every image to its target size, size with non positive dimensions keeps the original one.
+     * Invalid images don't interrupt the batch, they are returned as null.
+     */
+    @Keep
+    fun decode(images: List<ByteArray>, sizes: List<Size>): JxlBatchResult {
+        if (images.size != sizes.size) {
+            throw IllegalArgumentException("Every image must have its target size")
+        }
+        synchronized(lock) {
+            assertOpen()
+            val statistics = LongArray(5)
+            val bitmaps = decodeBatchImpl(
+                coordinator,
+                images.toTypedArray(),
+                IntArray(sizes.size) { sizes[it].width },
+                IntArray(sizes.size) { sizes[it].height },
+                statistics,
+            )
+            return JxlBatchResult(
+                bitmaps = bitmaps.toList(),
+                statistics = JxlBatchStatistics(
+                    decoded = statistics[0].toInt(),
+                    failed = statistics[1].toInt(),
+                    inputBytes = statistics[2],
+                    outputPixels = statistics[3],
+                    elapsedNanos = statistics[4],
+                ),
+            )
+        }
+    }
+
+    private fun assertOpen() {
+        if (coordinator == -1L) {
+            throw IllegalStateException("Batch decoder is already closed, call to it functions is impossible")
+        }
+    }
+
+    private external fun createBatchCoordinator(
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        jxlResizeSampler: Int,
+        javaToneMapper: Int,
+    ): Long
+
+    private external fun decodeBatchImpl(
+        coordinatorPtr: Long,
+        images: Array<ByteArray>,
+        widths: IntArray,
+        heights: IntArray,
+        statistics: LongArray,
+    ): Array<Bitmap?>
+
+    private external fun closeAndReleaseBatchDecoder(coordinatorPtr: Long)
+
+    override fun close() {
+        synchronized(lock) {
+            if (coordinator != -1L) {
+                closeAndReleaseBatchDecoder(coordinator)
+                coordinator = -1L
+            }
+        }
+    }
+
+    protected fun finalize() {
+        close()
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 06/03/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import androidx.annotation.Keep
+
+/**
+ * Throughput of one [JxlBatchDecoder.decode] call
+ * @param elapsedNanos wall time of the whole batch, bitmaps creation included
+ */
+@Keep
+data class JxlBatchStatistics(
+    val decoded: Int,
+    val failed: Int,
+    val inputBytes: Long,
+    val outputPixels: Long,
+    val elapsedNanos: Long,
+) {
+    val imagesPerSecond: Double
+        get() = if (elapsedNanos > 0) decoded * 1e9 / elapsedNanos else 0.0
+
+    val megapixelsPerSecond: Double
+        get() = if (elapsedNanos > 0) outputPixels * 1e3 / elapsedNanos else 0.0
+}
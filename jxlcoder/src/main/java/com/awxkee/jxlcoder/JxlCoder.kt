@@ -65,6 +65,9 @@ object JxlCoder {
     }
 
     /**
+     * @param linearLight resample colours in linear light instead of sRGB encoded values,
+     * keeps fine detail from darkening in downscales. Applies to images decoded in sRGB,
+     * HDR and other transfer functions are resampled as encoded
      * @author Radzivon Bartoshyk
      */
     fun decodeSampled(
@@ -75,6 +78,7 @@ object JxlCoder {
         scaleMode: ScaleMode = ScaleMode.FIT,
         jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.CATMULL_ROM,
         toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+        linearLight: Boolean = false,
     ): Bitmap {
         return decodeSampledImpl(
             byteArray,
@@ -82,12 +86,15 @@ object JxlCoder {
             height,
             preferredColorConfig.value,
             scaleMode.value,
-            jxlResizeFilter.value,
+            resizeFilterValue(jxlResizeFilter, linearLight),
             jxlToneMapper = toneMapper.value,
         )
     }
 
     /**
+     * @param linearLight resample colours in linear light instead of sRGB encoded values,
+     * keeps fine detail from darkening in downscales. Applies to images decoded in sRGB,
+     * HDR and other transfer functions are resampled as encoded
      * @author Radzivon Bartoshyk
      */
     fun decodeSampled(
@@ -98,6 +105,7 @@ object JxlCoder {
         scaleMode: ScaleMode = ScaleMode.FIT,
         jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.MITCHELL_NETRAVALI,
         toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+        linearLight: Boolean = false,
     ): Bitmap {
         return decodeByteBufferSampledImpl(
             byteArray,
@@ -105,6 +113,37 @@ object JxlCoder {
             height,
             preferredColorConfig.value,
             scaleMode.value,
+            resizeFilterValue(jxlResizeFilter, linearLight),
+            jxlToneMapper = toneMapper.value,
+        )
+    }
+
+    /**
+     * Decodes only the given region of the image, rows and columns outside of it are dropped while decoding
+     * @param x left edge of the region in displayed image coordinates
+     * @param y top edge of the region in displayed image coordinates
+     * @param scale downscale factor of the region in (0, 1]
+     * @author Radzivon Bartoshyk
+     */
+    fun decodeRegion(
+        byteArray: ByteArray,
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        scale: Float = 1f,
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.CATMULL_ROM,
+        toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+    ): Bitmap {
+        return decodeRegionImpl(
+            byteArray,
+            x,
+            y,
+            width,
+            height,
+            scale,
+            preferredColorConfig.value,
             jxlResizeFilter.value,
             jxlToneMapper = toneMapper.value,
         )
@@ -198,6 +237,37 @@ object JxlCoder {
         return getSizeImpl(byteArray)
     }
 
+    /**
+     * Reads image metadata from the headers only without decoding pixels
+     * @param countFrames walk frame headers of an animation to count frames, it reads the whole file
+     * @return NULL if byte array is not valid JPEG XL
+     */
+    fun getInfo(byteArray: ByteArray, countFrames: Boolean = false): JxlImageInfo? {
+        val values = getInfoImpl(byteArray, countFrames) ?: return null
+        return JxlImageInfo(
+            width = values[0].toInt(),
+            height = values[1].toInt(),
+            orientation = values[2].toInt(),
+            bitsPerSample = values[3].toInt(),
+            exponentBitsPerSample = values[4].toInt(),
+            hasAlpha = values[5] != 0L,
+            isAnimated = values[6] != 0L,
+            numberOfFrames = values[7].toInt(),
+            loopsCount = values[8].toInt(),
+            primaries = values[9].toInt(),
+            transferFunction = values[10].toInt(),
+            whitePoint = values[11].toInt(),
+            iccSize = values[12],
+        )
+    }
+
+    private fun resizeFilterValue(resizeFilter: JxlResizeFilter, linearLight: Boolean): Int {
+        return if (linearLight) resizeFilter.value or LINEAR_LIGHT_SAMPLING else resizeFilter.value
+    }
+
+    // Matches kLinearLightSampling in XScaler.h
+    private const val LINEAR_LIGHT_SAMPLING = 1 shl 8
+
     private external fun apng2JXLImpl(
         apngData: ByteArray,
         quality: Int,
@@ -218,6 +288,8 @@ object JxlCoder {
 
     private external fun getSizeImpl(byteArray: ByteArray): Size?
 
+    private external fun getInfoImpl(byteArray: ByteArray, countFrames: Boolean): LongArray?
+
     private external fun decodeSampledImpl(
         byteArray: ByteArray,
         width: Int,
@@ -228,6 +300,18 @@ object JxlCoder {
         jxlToneMapper: Int,
     ): Bitmap
 
+    private external fun decodeRegionImpl(
+        byteArray: ByteArray,
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        scale: Float,
+        preferredColorConfig: Int,
+        jxlResizeSampler: Int,
+        jxlToneMapper: Int,
+    ): Bitmap
+
     private external fun decodeByteBufferSampledImpl(
         byteArray: ByteBuffer,
         width: Int,
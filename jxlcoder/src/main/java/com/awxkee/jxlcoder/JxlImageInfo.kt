@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 4/3/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import androidx.annotation.Keep
+
+/**
+ * Image metadata read from the headers only, no pixels are decoded
+ * @param width displayed width, orientation already applied
+ * @param height displayed height, orientation already applied
+ * @param orientation EXIF orientation stored in the codestream, 1..8
+ * @param numberOfFrames frames count, 0 when frames were not counted for an animation
+ * @param loopsCount animation loops count, 0 means infinite, -1 for still images
+ * @param primaries, transferFunction, whitePoint libjxl enum values of the encoded colour space or -1 when an ICC profile is used
+ * @param iccSize size of the ICC profile libjxl reports for the image
+ */
+@Keep
+data class JxlImageInfo(
+    val width: Int,
+    val height: Int,
+    val orientation: Int,
+    val bitsPerSample: Int,
+    val exponentBitsPerSample: Int,
+    val hasAlpha: Boolean,
+    val isAnimated: Boolean,
+    val numberOfFrames: Int,
+    val loopsCount: Int,
+    val primaries: Int,
+    val transferFunction: Int,
+    val whitePoint: Int,
+    val iccSize: Long,
+)
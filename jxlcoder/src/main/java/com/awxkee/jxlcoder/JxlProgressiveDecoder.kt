@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 3/3/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import androidx.annotation.Keep
+
+/**
+ * Streaming decoder that emits the 1:8 preview first and then refined passes.
+ * Show [getImage] on every [JxlStreamingStatus.PASS] returned by [process].
+ */
+@Keep
+class JxlProgressiveDecoder @Keep constructor(
+    preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+    scaleMode: ScaleMode = ScaleMode.FIT,
+    jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.CATMULL_ROM,
+    toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+) : JxlStreamingDecoder(
+    progressive = true,
+    preferredColorConfig = preferredColorConfig,
+    scaleMode = scaleMode,
+    jxlResizeFilter = jxlResizeFilter,
+    toneMapper = toneMapper,
+)
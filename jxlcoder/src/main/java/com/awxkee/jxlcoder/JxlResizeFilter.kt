@@ -38,5 +38,10 @@ enum class JxlResizeFilter(internal val value: Int) {
     HERMITE(7),
     BSPLINE(8),
     HANN(9),
-    BICUBIC(10)
+    BICUBIC(10),
+
+    /**
+     * Averages every source pixel covered by the destination one, made for large downscales
+     */
+    AREA(11)
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Radzivon Bartoshyk
+ * jxl-coder [https://github.com/awxkee/jxl-coder]
+ *
+ * Created by Radzivon Bartoshyk on 3/3/2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.awxkee.jxlcoder
+
+import android.graphics.Bitmap
+import android.os.Build
+import androidx.annotation.Keep
+import java.io.Closeable
+
+/**
+ * Decodes JPEG XL while input chunks are arriving and keeps decoder state between them.
+ * Feed data with [append], call [process] until it reports [JxlStreamingStatus.COMPLETE]
+ * and follow [progress] in between.
+ */
+@Keep
+open class JxlStreamingDecoder : Closeable {
+
+    private var coordinator: Long = -1L
+    private val lock = Any()
+
+    /**
+     * @param progressive emit 1:8 preview and refined passes as [JxlStreamingStatus.PASS]
+     */
+    @Keep
+    public constructor(
+        progressive: Boolean = false,
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        scaleMode: ScaleMode = ScaleMode.FIT,
+        jxlResizeFilter: JxlResizeFilter = JxlResizeFilter.CATMULL_ROM,
+        toneMapper: JxlToneMapper = JxlToneMapper.LOGARITHMIC,
+    ) {
+        if (Build.VERSION.SDK_INT >= 21) {
+            System.loadLibrary("jxlcoder")
+        }
+        coordinator = createStreamingCoordinator(
+            progressive,
+            preferredColorConfig.value,
+            scaleMode.value,
+            jxlResizeFilter.value,
+            toneMapper.value,
+        )
+    }
+
+    @Keep
+    fun append(byteArray: ByteArray, offset: Int = 0, length: Int = byteArray.size - offset) {
+        synchronized(lock) {
+            assertOpen()
+            appendImpl(coordinator, byteArray, offset, length)
+        }
+    }
+
+    /**
+     * Marks that no more bytes will arrive, truncated input is reported as error afterwards
+     */
+    @Keep
+    fun closeInput() {
+        synchronized(lock) {
+            assertOpen()
+            closeInputImpl(coordinator)
+        }
+    }
+
+    @Keep
+    fun process(): JxlStreamingStatus {
+        synchronized(lock) {
+            assertOpen()
+            val status = processImpl(coordinator)
+            return JxlStreamingStatus.values().first { it.value == status }
+        }
+    }
+
+    val progress: JxlStreamingProgress
+        @Keep
+        get() {
+            synchronized(lock) {
+                assertOpen()
+                val values = getProgressImpl(coordinator)
+                return JxlStreamingProgress(
+                    bytesReceived = values[0],
+                    bytesConsumed = values[1],
+                    decodedPixels = values[2],
+                    totalPixels = values[3],
+                    passes = values[4].toInt(),
+                    hasBasicInfo = values[5] != 0L,
+                    isComplete = values[6] != 0L,
+                )
+            }
+        }
+
+    /**
+     * @return current pass of the image or null if nothing is decoded yet
+     */
+    @Keep
+    fun getImage(scaleWidth: Int = 0, scaleHeight: Int = 0): Bitmap? {
+        synchronized(lock) {
+            assertOpen()
+            return getImageImpl(coordinator, scaleWidth, scaleHeight)
+        }
+    }
+
+    /**
+     * Downsampling ratio of the current pass, 8 for DC preview and 1 for the final image
+     */
+    val downsamplingRatio: Int
+        @Keep
+        get() {
+            synchronized(lock) {
+                assertOpen()
+                return getDownsamplingRatioImpl(coordinator)
+            }
+        }
+
+    private fun assertOpen() {
+        if (coordinator == -1L) {
+            throw IllegalStateException("Streaming decoder is already closed, call to it functions is impossible")
+        }
+    }
+
+    private external fun createStreamingCoordinator(
+        progressive: Boolean,
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        jxlResizeSampler: Int,
+        javaToneMapper: Int,
+    ): Long
+
+    private external fun appendImpl(coordinatorPtr: Long, byteArray: ByteArray, offset: Int, length: Int)
+    private external fun closeInputImpl(coordinatorPtr: Long)
+    private external fun processImpl(coordinatorPtr: Long): Int
+    private external fun getImageImpl(coordinatorPtr: Long, width: Int, height: Int): Bitmap?
+    private external fun getDownsamplingRatioImpl(coordinatorPtr: Long): Int
+    private external fun getProgressImpl(coordinatorPtr: Long): LongArray
+    private external fun closeAndReleaseStreamingDecoder(coordinatorPtr: Long)
+
+    override fun close() {
+        synchronized(lock) {
+            if (coordinator != -1L) {
+                closeAndReleaseStreamingDecoder(coordinator)
+                coordinator = -1L
+            }
+        }
+    }
+
+    protected fun finalize() {
+        close()
+    }
+}